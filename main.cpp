@@ -1,5 +1,6 @@
 ﻿#include <iostream>
 #include <vector>
+#include <unordered_map>
 #include <map>
 #include <string>
 #include <cmath>
@@ -8,6 +9,35 @@
 #include <memory>
 #include <iomanip>
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <new>
+#include <fstream>
+#include <type_traits>
+#include <limits>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 코루틴 전략 API(StrategyExecutor)는 C++20 이상이고 <coroutine>이 있을 때만 포함 (-std=c++20)
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define STOCKSIM_COROUTINES 1
+#endif
+#endif
 
 using namespace std;
 
@@ -21,884 +51,8017 @@ class MarketState;
 class NormalState;
 class DisruptedState;
 class DisruptionDetector;
+class SimulationSnapshot;
 
 // ============================================================
-// 팀원 A: Stock 클래스
+// 공통: 힙 할당 계수기 (벤치마크의 op당 할당 횟수 측정용, 컴파일 시 선택)
 // ============================================================
-class Stock {
-private:
-    string name;
-    double currentPrice;
-    double previousPrice;
-    double volume;
-    double averageVolume;
-
-public:
-    Stock(const string& name, double initPrice, double initVolume)
-        : name(name), currentPrice(initPrice), previousPrice(initPrice),
-        volume(initVolume), averageVolume(initVolume) {
+// -DSTOCKSIM_BENCH=1 로 빌드하면 전역 operator new/delete(정렬, nothrow 포함)를 대체하여 스레드별로 할당 횟수를 센다.
+// 기본 빌드에서는 대체하지 않으며 count()는 항상 0이다 (--bench는 allocs/op를 "-"로 표시).
+// new/delete를 인라인하면 GCC가 malloc/free 짝을 잘못 짚어 -Wmismatched-new-delete 오탐을 내므로 인라인 금지.
+#ifndef STOCKSIM_BENCH
+#define STOCKSIM_BENCH 0
+#endif
+
+struct AllocationCounter {
+    static constexpr bool ENABLED = STOCKSIM_BENCH != 0;
+
+    static uint64_t& count() {
+        static thread_local uint64_t n = 0;
+        return n;
     }
+};
 
-    void updatePrice(double newPrice) {
-        previousPrice = currentPrice;
-        currentPrice = newPrice;
-    }
+#if STOCKSIM_BENCH
+__attribute__((noinline)) void* operator new(size_t size, const nothrow_t&) noexcept {
+    ++AllocationCounter::count();
 
-    double getFluctuationRate() const {
-        if (previousPrice == 0) return 0.0;
-        return (currentPrice - previousPrice) / previousPrice;  // 비율 반환 (0.05 = 5%)
-    }
+    return malloc(size == 0 ? 1 : size);
+}
 
-    void setVolume(double newVolume) {
-        volume = newVolume;
-        // EMA 평균 거래량
-        averageVolume = averageVolume * 0.95 + newVolume * 0.05;
-    }
+__attribute__((noinline)) void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept {
+    ++AllocationCounter::count();
 
-    double getAverageVolume() const { return averageVolume; }
+    void* p = nullptr;
+    size_t alignment = max(static_cast<size_t>(align), sizeof(void*));
 
-    double getVolumeRatio() const {
-        if (averageVolume == 0) return 0.0;
-        return volume / averageVolume;
-    }
+    return posix_memalign(&p, alignment, size == 0 ? 1 : size) == 0 ? p : nullptr;
+}
 
-    string getName() const { return name; }
+__attribute__((noinline)) void* operator new(size_t size) {
+    if (void* p = operator new(size, nothrow)) return p;
 
-    double getCurrentPrice() const { return currentPrice; }
+    throw bad_alloc();
+}
 
-    double getPreviousPrice() const { return previousPrice; }
+__attribute__((noinline)) void* operator new(size_t size, align_val_t align) {
+    if (void* p = operator new(size, align, nothrow)) return p;
 
-    double getVolume() const { return volume; }
-};
+    throw bad_alloc();
+}
 
-// ============================================================
-// 팀원 A: Transaction 클래스
-// ============================================================
-class Transaction {
-private:
-    string stockName;
-    string type;
-    int quantity;
-    double price;
-    double totalAmount;
-    bool isGapTrade;
-    time_t timestamp;
-    double profitRate;      // 청산 시 수익률 (매수 시에는 0)
-    double profitAmount;    // 청산 시 손익 금액
+void* operator new[](size_t size) { return operator new(size); }
 
-public:
-    Transaction(const string& stockName, const string& type, int quantity, double price, bool isGapTrade = false)
-        : stockName(stockName), type(type), quantity(quantity), price(price), isGapTrade(isGapTrade),
-          profitRate(0.0), profitAmount(0.0) {
-        totalAmount = price * quantity;
-        timestamp = time(nullptr);
-    }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return operator new(size, nothrow); }
 
-    void printLog() const {
-        cout << "[" << put_time(localtime(&timestamp), "%Y-%m-%d %H:%M:%S") << "] "
-            << (isGapTrade ? "[갭] " : "")
-            << type << " " << stockName
-            << " | 수량: " << quantity
-            << " | 가격: " << fixed << setprecision(2) << price
-            << " | 총액: " << totalAmount;
+void* operator new[](size_t size, align_val_t align) { return operator new(size, align); }
 
-        // 청산 거래인 경우 수익률 표시
-        if (type.find("청산") != string::npos && (profitRate != 0.0 || profitAmount != 0.0)) {
-            cout << " | 수익률: " << fixed << setprecision(2) << (profitRate * 100) << "%"
-                 << " | 손익: " << fixed << setprecision(0) << profitAmount;
-        }
-        cout << endl;
-    }
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept { return operator new(size, align, nothrow); }
 
-    void setProfitInfo(double rate, double amount) {
-        profitRate = rate;
-        profitAmount = amount;
-    }
+// posix_memalign으로 받은 블록도 free로 해제한다.
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
 
-    string getType() const { return type; }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { free(p); }
 
-    void setType(const string& t) { type = t; }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
 
-    void setGapTradeFlag(bool flag) { isGapTrade = flag; }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { free(p); }
 
-    string getStockName() const { return stockName; }
+__attribute__((noinline)) void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
 
-    int getQuantity() const { return quantity; }
+__attribute__((noinline)) void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
 
-    double getPrice() const { return price; }
+__attribute__((noinline)) void operator delete(void* p, align_val_t) noexcept { free(p); }
 
-    double getTotalAmount() const { return totalAmount; }
+__attribute__((noinline)) void operator delete[](void* p, align_val_t) noexcept { free(p); }
 
-    bool getIsGapTrade() const { return isGapTrade; }
+__attribute__((noinline)) void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
 
-    time_t getTimestamp() const { return timestamp; }
-};
+__attribute__((noinline)) void operator delete[](void* p, size_t, align_val_t) noexcept { free(p); }
+
+__attribute__((noinline)) void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { free(p); }
+
+__attribute__((noinline)) void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { free(p); }
+#endif
 
 // ============================================================
-// 팀원 A: Market 클래스
+// 공통: Arena (시뮬레이션 단위 bump 할당기)
 // ============================================================
-class Market {
+// 큰 청크를 잡아 두고 포인터를 앞으로 밀며 나눠 준다. 개별 해제는 하지 않고,
+// reset()은 커서만 첫 청크로 되돌리므로 O(1)이며 청크는 다음 시뮬레이션에서 그대로 재사용한다.
+// Market/Trader에 넘기면 종목 뷰, 배열 버퍼, 메모리 거래 저널이 모두 이 안에 놓인다.
+// 넘긴 Arena는 그 객체들보다 오래 살아야 하며, reset()은 객체들이 소멸한 뒤에만 호출한다.
+class Arena {
 private:
-    vector<Stock*> allStocks;
-    vector<Transaction> transactionHistory;
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
 
-public:
-    Market() {}
+    vector<Chunk> chunks;       // 확보한 청크 (reset 후에도 유지)
+    size_t current;             // 할당 중인 청크 번호
+    size_t offset;              // 현재 청크 안의 다음 위치
+    size_t nextChunkBytes;      // 새 청크 크기 (확보할 때마다 2배, 최대 MAX_CHUNK_BYTES)
 
-    ~Market() {
-        for (Stock* stock : allStocks) {
-            delete stock;
-        }
+    static constexpr size_t MAX_CHUNK_BYTES = 16 << 20;
 
-        allStocks.clear();
+public:
+    explicit Arena(size_t initialChunkBytes = 64 * 1024)
+        : current(0), offset(0), nextChunkBytes(initialChunkBytes) {
     }
 
-    void addStock(Stock* stock) {
-        allStocks.push_back(stock);
+    ~Arena() {
+        for (const Chunk& c : chunks) ::operator delete(c.data);
     }
 
-    void simulateFluctuation() {
-        for (Stock* stock : allStocks) {
-			double randomValue = (double)rand() / RAND_MAX;  // 0.0 ~ 1.0
-            double changeRate;
-            double volumeMultiplier;
-
-			// 시장 변동 시뮬레이션
-            if (randomValue < 0.95) {
-				// 95% 확률로 정상
-				changeRate = ((double)rand() / RAND_MAX) * 0.04 - 0.02;  // -2% ~ +2%
-                volumeMultiplier = 0.8 + ((double)rand() / RAND_MAX) * 0.4;
-            }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
 
-            else {
-				// 5% 확률로 블랙스완
-				changeRate = ((double)rand() / RAND_MAX) * (-0.20) - 0.10;  // -10% ~ -30%
-                volumeMultiplier = 2.0 + ((double)rand() / RAND_MAX) * 2.0;
-            }
+    // align은 2의 거듭제곱, max_align_t 이하
+    void* allocate(size_t bytes, size_t align) {
+        while (true) {
+            if (current < chunks.size()) {
+                const Chunk& c = chunks[current];
+                size_t aligned = (offset + align - 1) & ~(align - 1);
 
-            double newPrice = stock->getCurrentPrice() * (1.0 + changeRate);
+                if (aligned + bytes <= c.size) {
+                    offset = aligned + bytes;
+                    return c.data + aligned;
+                }
 
-            if (newPrice < 0.01) newPrice = 0.01;
+                // 남은 자리가 모자라면 다음 청크 (reset 전에 확보해 둔 청크부터)
+                ++current;
+                offset = 0;
+                continue;
+            }
 
-            double newVolume = stock->getAverageVolume() * volumeMultiplier;
-            stock->updatePrice(newPrice);
-            stock->setVolume(newVolume);
+            size_t size = max(nextChunkBytes, bytes);
+            nextChunkBytes = min(nextChunkBytes * 2, MAX_CHUNK_BYTES);
+            chunks.push_back(Chunk{ static_cast<char*>(::operator new(size)), size });
         }
     }
 
-    Stock* getStockByName(const string& name) const {
-        for (Stock* stock : allStocks) {
-            if (stock->getName() == name) {
-                return stock;
-            }
-        }
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+    }
 
-        return nullptr;
+    // 모든 할당을 한 번에 무효화 (청크 유지)
+    void reset() {
+        current = 0;
+        offset = 0;
     }
 
-    double getMarketVolatility() const {
-        if (allStocks.empty()) return 0.0;
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (const Chunk& c : chunks) total += c.size;
+        return total;
+    }
+};
 
-        double sum = 0.0;
+// 표준 컨테이너용 할당자: arena가 있으면 Arena에서 할당하고 해제는 무시, 없으면 일반 힙
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
 
-        for (Stock* stock : allStocks) {
-            sum += stock->getFluctuationRate();
-        }
+    Arena* arena;
 
-        double mean = sum / allStocks.size();
+    ArenaAllocator(Arena* arena = nullptr) noexcept : arena(arena) {}
 
-        double variance = 0.0;
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
 
-        for (Stock* stock : allStocks) {
-            double diff = stock->getFluctuationRate() - mean;
-            variance += diff * diff;
-        }
+    T* allocate(size_t n) {
+        if (arena) return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
 
-        variance /= allStocks.size();
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
 
-        // 시장 변동성
-        return sqrt(variance);  // 0.0 ~ 1.0
+    void deallocate(T* p, size_t) noexcept {
+        if (!arena) ::operator delete(p);
     }
 
-    double getAverageVolume() const {
-        if (allStocks.empty()) return 0.0;
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
 
-        double sum = 0.0;
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
 
-        for (Stock* stock : allStocks) {
-            sum += stock->getVolume();
-        }
+template <typename T>
+using ArenaVector = vector<T, ArenaAllocator<T>>;
 
-        return sum / allStocks.size();
-    }
+// Arena 또는 힙에 만든 객체를 소유하는 unique_ptr용 삭제자 (Arena면 소멸자만 호출)
+template <typename T>
+struct ArenaDeleter {
+    Arena* arena = nullptr;
 
-    void addTransaction(const Transaction& t) {
-        transactionHistory.push_back(t);
+    void operator()(T* p) const {
+        if (arena) p->~T();
+        else delete p;
     }
+};
 
-    void printMarketStatus() const {
-        cout << "\n====== 시장 현황 ======" << endl;
+template <typename T>
+using ArenaPtr = unique_ptr<T, ArenaDeleter<T>>;
 
-        cout << "시장 변동성: " << fixed << setprecision(4)
-            << (getMarketVolatility() * 100) << "%" << endl;
+template <typename T, typename... Args>
+ArenaPtr<T> makeArenaPtr(Arena* arena, Args&&... args) {
+    T* p = arena ? arena->create<T>(forward<Args>(args)...) : new T(forward<Args>(args)...);
+    return ArenaPtr<T>(p, ArenaDeleter<T>{ arena });
+}
 
-        cout << "평균 거래량: " << fixed << setprecision(0)
-            << getAverageVolume() << endl;
+// ============================================================
+// 공통: Profiler (핫패스 시간 측정 프로브, 컴파일 시 선택)
+// ============================================================
+// -DSTOCKSIM_PROFILE 로 빌드하면 PROFILE_SCOPE(Probe::X)가 함수 구간의 경과 시간을 스레드별 지연 히스토그램에 기록한다.
+// 기본 빌드에서는 매크로가 빈 문장이 되어 오버헤드가 없다.
+// 히스토그램은 HDR 방식(로그-선형): 2의 거듭제곱 구간마다 32칸 -> 상대 오차 약 3%, 1ns ~ 약 39시간.
+// 스레드는 처음 기록할 때 자기 히스토그램 묶음을 전역 목록에 한 번 등록하고 이후에는 잠금 없이 기록한다.
+// 실행이 끝나면 모든 스레드 것을 합쳐 JSON / Prometheus 텍스트 형식으로 내보낸다.
+#ifndef STOCKSIM_PROFILE
+#define STOCKSIM_PROFILE 0
+#endif
+
+enum class Probe : uint8_t {
+    SimulateFluctuation,
+    AnalyzeMarket,
+    ExecuteStrategy,
+    AutoTrade,
+    Buy,
+    Sell,
+    BuyGapPosition,
+    CloseGapPosition,
+    PrintMarketStatus,
+    PrintTransactionHistory,
+    PrintPortfolioStatus,
+    PrintGapPositionStatus,
+    Count
+};
 
-        cout << "\n[종목별 현황]" << endl;
+constexpr size_t PROBE_COUNT = static_cast<size_t>(Probe::Count);
+
+inline const char* probeName(Probe probe) {
+    static const char* const names[PROBE_COUNT] = {
+        "Market::simulateFluctuation",
+        "DisruptionDetector::analyzeMarket",
+        "DisruptionDetector::executeStrategy",
+        "Trader::autoTrade",
+        "Trader::buy",
+        "Trader::sell",
+        "Trader::buyGapPosition",
+        "Trader::closeGapPosition",
+        "Market::printMarketStatus",
+        "Market::printTransactionHistory",
+        "Trader::printPortfolioStatus",
+        "Trader::printGapPositionStatus"
+    };
+
+    return names[static_cast<size_t>(probe)];
+}
 
-        for (Stock* stock : allStocks) {
-            cout << stock->getName()
-                << " | 현재가: " << fixed << setprecision(2) << stock->getCurrentPrice()
-                << " | 변동성: " << fixed << setprecision(2) << (stock->getFluctuationRate() * 100) << "%"
-                << " | 거래량 비율: " << fixed << setprecision(2) << (stock->getVolumeRatio() * 100) << "%"
-                << " | 평균 거래량: " << (long long)stock->getAverageVolume()
-                << endl;
-        }
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;    // 구간당 칸 수
+    static constexpr uint32_t MAX_BITS = 47;                   // 이보다 큰 값은 마지막 칸
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 2) * SUB_COUNT;
 
-        cout << "=======================\n" << endl;
-    }
+private:
+    array<uint64_t, BUCKETS> counts;
+    uint64_t total;
+    uint64_t sumNs;
+    uint64_t minNs;
+    uint64_t maxNs;
 
-    void printTransactionHistory() const {
-        cout << "\n====== 거래 내역 ======" << endl;
+    // 32 미만은 값 그대로, 그 이상은 (최상위 비트 위치, 그 아래 5비트)로 칸 결정
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB_COUNT) return static_cast<size_t>(ns);
 
-        for (const Transaction& t : transactionHistory) {
-            t.printLog();
-        }
+        uint32_t msb = min<uint32_t>(63 - static_cast<uint32_t>(__builtin_clzll(ns)), MAX_BITS);
+        uint32_t shift = msb - SUB_BITS;
+        uint64_t mantissa = min<uint64_t>(ns >> shift, 2 * SUB_COUNT - 1);
 
-        cout << "=======================\n" << endl;
+        return static_cast<size_t>((shift + 1) * SUB_COUNT + (mantissa - SUB_COUNT));
     }
 
-    const vector<Stock*>& getAllStocks() const { return allStocks; }
-    const vector<Transaction>& getTransactionHistory() const { return transactionHistory; }
-};
+    // 칸의 대표값 (칸 범위의 가운데)
+    static double bucketValue(size_t bucket) {
+        if (bucket < SUB_COUNT) return static_cast<double>(bucket);
 
-// ============================================================
-// 팀원 B: Position 구조체
-// ============================================================
-struct Position {
-    Stock* stock;
-    int quantity;
-    double avgBuyPrice;
-    time_t buyTimestamp;
+        uint64_t shift = bucket / SUB_COUNT - 1;
+        uint64_t low = (SUB_COUNT + bucket % SUB_COUNT) << shift;
 
-    // 생성자
-    Position(Stock* s = nullptr, int qty = 0, double price = 0.0)
-        : stock(s), quantity(qty), avgBuyPrice(price) {
-        buyTimestamp = time(nullptr);
+        return static_cast<double>(low) + static_cast<double>(1ull << shift) * 0.5;
     }
-};
 
-// ============================================================
-// 팀원 B: Trader 클래스
-// ============================================================
-class Trader {
-private:
-    string username;
-    double cash;
-    map<string, Position> portfolio;
-    map<string, Position> gapPositions;
-    unique_ptr<DisruptionDetector> detector;
-    
 public:
-    Trader(const string& name, double initialCash)
-        : username(name), cash(initialCash) {
-        detector = make_unique<DisruptionDetector>();
+    LatencyHistogram() { clear(); }
+
+    void clear() {
+        counts.fill(0);
+        total = 0;
+        sumNs = 0;
+        minNs = numeric_limits<uint64_t>::max();
+        maxNs = 0;
     }
 
-    bool buy(const string& stockName, int qty, Market& m) {
-        if (qty <= 0) return false;
-
-        Stock* stock = m.getStockByName(stockName);
+    void record(uint64_t ns) {
+        ++counts[bucketOf(ns)];
+        ++total;
+        sumNs += ns;
+        minNs = min(minNs, ns);
+        maxNs = max(maxNs, ns);
+    }
 
-        if (!stock) return false;
+    void merge(const LatencyHistogram& other) {
+        for (size_t b = 0; b < BUCKETS; ++b) counts[b] += other.counts[b];
 
-        double price = stock->getCurrentPrice();
-        double cost = price * qty;
+        total += other.total;
+        sumNs += other.sumNs;
+        minNs = min(minNs, other.minNs);
+        maxNs = max(maxNs, other.maxNs);
+    }
 
-        if (cost > cash) return false;
+    // q (0 ~ 1) 분위수 [ns], 최소/최대 범위로 자름
+    double percentile(double q) const {
+        if (total == 0) return 0.0;
 
-        // 거래 내역 기록
-        Transaction t(stockName, "매수", qty, price, false);
-        m.addTransaction(t);
+        uint64_t rank = static_cast<uint64_t>(ceil(q * static_cast<double>(total)));
+        rank = max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
 
-        // 포트폴리오 업데이트 (가중 평균 단가)
-        auto it = portfolio.find(stockName);
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
 
-        if (it == portfolio.end()) {
-            portfolio[stockName] = Position(stock, qty, price);
+            if (seen >= rank) {
+                double v = bucketValue(b);
+                return min(max(v, static_cast<double>(minNs)), static_cast<double>(maxNs));
+            }
         }
 
-        else {
-            Position& pos = it->second;
-            int newQty = pos.quantity + qty;
-            double newAvg = (pos.avgBuyPrice * pos.quantity + price * qty) / newQty;
-            pos.quantity = newQty;
-            pos.avgBuyPrice = newAvg;
-            pos.buyTimestamp = time(nullptr);
-        }
+        return static_cast<double>(maxNs);
+    }
 
-        // 현금 차감
-        cash -= cost;
+    uint64_t getCount() const { return total; }
+    uint64_t getSumNs() const { return sumNs; }
+    uint64_t getMinNs() const { return total ? minNs : 0; }
+    uint64_t getMaxNs() const { return maxNs; }
+};
 
-        return true;
+class Profiler {
+public:
+    static constexpr bool ENABLED = STOCKSIM_PROFILE != 0;
+
+    using ProbeSet = array<LatencyHistogram, PROBE_COUNT>;
+
+private:
+    mutex mtx;
+    vector<unique_ptr<ProbeSet>> threads;   // 스레드별 히스토그램 (스레드가 끝나도 보존)
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
     }
 
-    bool sell(const string& stockName, int qty, Market& m) {
-        if (qty <= 0) return false;
+    static ProbeSet* registerThread() {
+        Profiler& p = instance();
+        lock_guard<mutex> lock(p.mtx);
 
-        auto it = portfolio.find(stockName);
+        p.threads.push_back(make_unique<ProbeSet>());
+        return p.threads.back().get();
+    }
 
-        if (it == portfolio.end()) return false;
+    static void writePrometheusMetric(FILE* out, const char* name, const char* probe, const char* quantile, double value) {
+        if (quantile) fprintf(out, "%s{probe=\"%s\",quantile=\"%s\"} %.9g\n", name, probe, quantile, value);
+        else fprintf(out, "%s{probe=\"%s\"} %.9g\n", name, probe, value);
+    }
 
-        Position& pos = it->second;
+public:
+    // 현재 스레드의 히스토그램 묶음 (처음 호출 때 등록)
+    static ProbeSet& local() {
+        static thread_local ProbeSet* set = registerThread();
+        return *set;
+    }
 
-        if (qty > pos.quantity) return false;
+    static void record(Probe probe, uint64_t ns) {
+        local()[static_cast<size_t>(probe)].record(ns);
+    }
 
-        Stock* stock = pos.stock ? pos.stock : m.getStockByName(stockName);
+    // 모든 스레드 합계 (측정 중인 스레드가 없을 때 호출)
+    static ProbeSet collect() {
+        Profiler& p = instance();
+        lock_guard<mutex> lock(p.mtx);
 
-        if (!stock) return false;
+        ProbeSet merged;
 
-        double price = stock->getCurrentPrice();
+        for (const auto& set : p.threads) {
+            for (size_t i = 0; i < PROBE_COUNT; ++i) merged[i].merge((*set)[i]);
+        }
 
-        // 거래 내역 기록
-        Transaction t(stockName, "청산", qty, price, false);
-        m.addTransaction(t);
+        return merged;
+    }
 
-        double revenue = price * qty;
+    static size_t threadCount() {
+        Profiler& p = instance();
+        lock_guard<mutex> lock(p.mtx);
 
-        // 포지션 및 현금 업데이트
-        pos.quantity -= qty;
+        return p.threads.size();
+    }
+
+    static bool writeJson(const string& path) {
+        FILE* out = fopen(path.c_str(), "w");
+        if (!out) return false;
+
+        ProbeSet merged = collect();
+
+        fprintf(out, "{\n  \"enabled\": %s,\n  \"threads\": %zu,\n  \"probes\": [", ENABLED ? "true" : "false", threadCount());
 
-        if (pos.quantity == 0) {
-            portfolio.erase(it);
+        bool first = true;
+
+        for (size_t i = 0; i < PROBE_COUNT; ++i) {
+            const LatencyHistogram& h = merged[i];
+            if (h.getCount() == 0) continue;
+
+            fprintf(out, "%s\n    {\"name\": \"%s\", \"count\": %llu, \"total_ns\": %llu, \"mean_ns\": %.1f, "
+                         "\"min_ns\": %llu, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %llu}",
+                    first ? "" : ",", probeName(static_cast<Probe>(i)),
+                    static_cast<unsigned long long>(h.getCount()), static_cast<unsigned long long>(h.getSumNs()),
+                    static_cast<double>(h.getSumNs()) / h.getCount(), static_cast<unsigned long long>(h.getMinNs()),
+                    h.percentile(0.50), h.percentile(0.90), h.percentile(0.99), h.percentile(0.999),
+                    static_cast<unsigned long long>(h.getMaxNs()));
+            first = false;
         }
 
-        cash += revenue;
+        fprintf(out, "\n  ]\n}\n");
 
-        return true;
+        return fclose(out) == 0;
     }
 
-    void autoTrade(Market& m);  // DisruptionDetector 정의 후 구현
+    // Prometheus 텍스트 형식: 프로브별 지연 summary(초 단위) + 호출 횟수 counter
+    static bool writePrometheus(const string& path) {
+        FILE* out = fopen(path.c_str(), "w");
+        if (!out) return false;
 
-    bool buyGapPosition(const string& stockName, int qty, Market& m) {
-        if (qty <= 0) return false;
+        ProbeSet merged = collect();
 
-        Stock* stock = m.getStockByName(stockName);
+        fprintf(out, "# HELP stocksim_probe_latency_seconds Hot path latency per probe.\n");
+        fprintf(out, "# TYPE stocksim_probe_latency_seconds summary\n");
 
-        if (!stock) return false;
+        const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+        const char* const labels[] = { "0.5", "0.9", "0.99", "0.999" };
 
-        double price = stock->getCurrentPrice();
-        double cost = price * qty;
+        for (size_t i = 0; i < PROBE_COUNT; ++i) {
+            const LatencyHistogram& h = merged[i];
+            if (h.getCount() == 0) continue;
 
-        if (cost > cash) return false;
+            const char* probe = probeName(static_cast<Probe>(i));
 
-        auto it = gapPositions.find(stockName);
+            for (size_t q = 0; q < 4; ++q) {
+                writePrometheusMetric(out, "stocksim_probe_latency_seconds", probe, labels[q], h.percentile(quantiles[q]) * 1e-9);
+            }
 
-        if (it == gapPositions.end()) {
-            gapPositions[stockName] = Position(stock, qty, price);
+            writePrometheusMetric(out, "stocksim_probe_latency_seconds_sum", probe, nullptr, h.getSumNs() * 1e-9);
+            writePrometheusMetric(out, "stocksim_probe_latency_seconds_count", probe, nullptr, static_cast<double>(h.getCount()));
         }
 
-        else {
-            Position& pos = it->second;
-            int newQty = pos.quantity + qty;
-            double newAvg = (pos.avgBuyPrice * pos.quantity + price * qty) / newQty;
-            pos.quantity = newQty;
-            pos.avgBuyPrice = newAvg;
-            pos.buyTimestamp = time(nullptr);
-        }
+        fprintf(out, "# HELP stocksim_probe_calls_total Probe invocations.\n");
+        fprintf(out, "# TYPE stocksim_probe_calls_total counter\n");
 
-        Transaction t(stockName, "갭 매수", qty, price, true);
-        m.addTransaction(t);
+        for (size_t i = 0; i < PROBE_COUNT; ++i) {
+            if (merged[i].getCount() == 0) continue;
 
-        cash -= cost;
+            writePrometheusMetric(out, "stocksim_probe_calls_total", probeName(static_cast<Probe>(i)), nullptr,
+                                  static_cast<double>(merged[i].getCount()));
+        }
 
-        return true;
+        return fclose(out) == 0;
     }
+};
 
-    void closeAllGapPositions(Market& m) {
-        // 키를 복사해두고 순회 중 맵을 수정
-        vector<string> keys;
-        keys.reserve(gapPositions.size());
+// 구간 시작~소멸까지의 경과 시간을 기록
+class ProfileScope {
+private:
+    Probe probe;
+    chrono::steady_clock::time_point start;
 
-        for (const auto& kv : gapPositions) {
-            keys.push_back(kv.first);
-        }
+public:
+    explicit ProfileScope(Probe probe) : probe(probe), start(chrono::steady_clock::now()) {}
 
-        for (const string& name : keys) {
-            closeGapPosition(name, m);
-        }
+    ~ProfileScope() {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        Profiler::record(probe, static_cast<uint64_t>(ns));
     }
 
-    bool closeGapPosition(const string& stockName, Market& m) {
-        auto it = gapPositions.find(stockName);
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
 
-        if (it == gapPositions.end()) return false;
+// 소멸 시 지정된 경로로 측정 결과를 기록 (main의 모든 종료 경로에서 내보내기 위함)
+class ProfileExporter {
+private:
+    string jsonPath;
+    string prometheusPath;
 
-        Position& pos = it->second;
+public:
+    ProfileExporter(string jsonPath, string prometheusPath);   // 오류 보고에 Logger를 쓰므로 Logger 정의 후 구현
 
-        if (pos.quantity <= 0) return false;
+    ~ProfileExporter();
 
-        Stock* stock = pos.stock ? pos.stock : m.getStockByName(stockName);
+    ProfileExporter(const ProfileExporter&) = delete;
+    ProfileExporter& operator=(const ProfileExporter&) = delete;
+};
 
-        if (!stock) return false;
+#if STOCKSIM_PROFILE
+#define PROFILE_SCOPE(probe) ProfileScope profileScope(probe)
+#else
+#define PROFILE_SCOPE(probe) ((void)0)
+#endif
 
-        int qty = pos.quantity;
-        double currentPrice = stock->getCurrentPrice();
-        double avgBuyPrice = pos.avgBuyPrice;
-        double revenue = currentPrice * qty;
+// ============================================================
+// 공통: Philox4x32-10 카운터 기반 난수 생성기
+// ============================================================
+// 내부 상태 없이 (카운터, 키) -> 난수 4개를 계산하는 순수 함수.
+// 같은 (seed, day, 종목 인덱스)는 실행 순서·스레드 수와 무관하게 항상 같은 난수를 만든다.
+class Philox4x32 {
+private:
+    static constexpr uint32_t M0 = 0xD2511F53u;
+    static constexpr uint32_t M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u;
+    static constexpr uint32_t W1 = 0xBB67AE85u;
+    static constexpr int ROUNDS = 10;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
 
-        // 수익률 계산
-        double profitRate = (currentPrice - avgBuyPrice) / avgBuyPrice;
-        double profitAmount = (currentPrice - avgBuyPrice) * qty;
+public:
+    using Counter = array<uint32_t, 4>;
+    using Key = array<uint32_t, 2>;
 
-        Transaction t(stockName, "갭 청산", qty, currentPrice, true);
-        t.setProfitInfo(profitRate, profitAmount);
-        m.addTransaction(t);
-        gapPositions.erase(it);
+    static Counter generate(Counter ctr, Key key) {
+        for (int round = 0; round < ROUNDS; ++round) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(M0, ctr[0], hi0, lo0);
+            mulhilo(M1, ctr[2], hi1, lo1);
 
-        cash += revenue;
+            ctr = { hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0 };
 
-        return true;
+            key[0] += W0;
+            key[1] += W1;
+        }
+
+        return ctr;
     }
 
-    bool hasOpenGapPositions() const {
-        return !gapPositions.empty();
+    // (seed, day, index) 조합으로 난수 4개 생성
+    static Counter generate(uint64_t seed, uint64_t day, uint64_t index) {
+        Counter ctr = { static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+                        static_cast<uint32_t>(day), static_cast<uint32_t>(day >> 32) };
+        Key key = { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+
+        return generate(ctr, key);
     }
 
-    int getPositionQuantity(const string& stockName) const {
-        int qty = 0;
-        auto itNormal = portfolio.find(stockName);
+    // 32비트 정수 -> [0.0, 1.0) 실수
+    static double toUnit(uint32_t x) {
+        return x * (1.0 / 4294967296.0);
+    }
+};
 
-        if (itNormal != portfolio.end()) {
-            qty += itNormal->second.quantity;
-        }
+// 기준 시드 + 경로 번호 -> 경로별 독립 시드 (SplitMix64)
+uint64_t mixSeed(uint64_t seed, uint64_t stream) {
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
 
-        auto itGap = gapPositions.find(stockName);
+    return z ^ (z >> 31);
+}
 
-        if (itGap != gapPositions.end()) {
-            qty += itGap->second.quantity;
+// ============================================================
+// 공통: ThreadPool (작업 훔치기 스레드 풀)
+// ============================================================
+// 작업자마다 자기 작업 큐를 가지며, 자기 큐는 뒤에서 꺼내고(LIFO)
+// 비어 있으면 다른 작업자의 큐 앞에서 훔쳐온다(FIFO).
+// - parallelFor(chunkCount, fn): chunk 0..chunkCount-1을 나눠 실행하고 완료까지 대기.
+//   대기하는 동안 호출 스레드도 작업을 처리하고, 처리할 것이 없으면 완료 래치에서 잠든다.
+// 큐 항목은 (구간 작업 서술자, chunk 번호) 고정 크기 값이고 큐는 용량을 줄이지 않는 링 버퍼라
+// 정상 상태의 parallelFor는 힙 할당을 하지 않는다.
+class ThreadPool {
+private:
+    // 남은 chunk 수가 0이 되면 대기 스레드를 깨움. 감소와 통지를 같은 잠금 안에서 하므로
+    // 대기 스레드가 (잠금을 잡고) 0을 확인한 뒤에는 완료 쪽이 래치에 다시 손대지 않는다.
+    struct Latch {
+        size_t remaining;
+        mutex mtx;
+        condition_variable cv;
+
+        explicit Latch(size_t count) : remaining(count) {}
+
+        void countDown() {
+            lock_guard<mutex> lock(mtx);
+            if (--remaining == 0) cv.notify_all();
         }
 
-        return qty;
-    }
+        bool done() {
+            lock_guard<mutex> lock(mtx);
+            return remaining == 0;
+        }
 
-    double getTotalAssetValue(Market& m) const {
-        double total = cash;
+        void wait() {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [&] { return remaining == 0; });
+        }
+    };
+
+    // parallelFor 한 번의 서술자 (호출 스레드 스택에 있고 완료까지 살아 있음)
+    struct ChunkJob {
+        void (*invoke)(const void* fn, size_t chunk);
+        const void* fn;
+        Latch* latch;
+    };
+
+    struct Task {
+        const ChunkJob* job;
+        size_t chunk;
+    };
+
+    // 양쪽에서 꺼내는 링 버퍼 (가득 차면 2배로 키우고 줄이지 않음)
+    struct WorkQueue {
+        mutex mtx;
+        vector<Task> ring;
+        size_t head = 0;
+        size_t count = 0;
+
+        void pushBack(const Task& t) {
+            if (count == ring.size()) {
+                vector<Task> grown(max<size_t>(ring.size() * 2, 64));
+                for (size_t k = 0; k < count; ++k) grown[k] = ring[(head + k) % ring.size()];
+                ring.swap(grown);
+                head = 0;
+            }
 
-        // 일반 포트폴리오 가치
-        for (const auto& kv : portfolio) {
-            const string& name = kv.first;
-            const Position& pos = kv.second;
-            Stock* stock = pos.stock ? pos.stock : m.getStockByName(name);
-            if (!stock) continue;
-            total += stock->getCurrentPrice() * pos.quantity;
+            ring[(head + count) % ring.size()] = t;
+            ++count;
         }
 
-        // 갭 포지션 가치
-        for (const auto& kv : gapPositions) {
-            const string& name = kv.first;
-            const Position& pos = kv.second;
-            Stock* stock = pos.stock ? pos.stock : m.getStockByName(name);
-            if (!stock) continue;
-            total += stock->getCurrentPrice() * pos.quantity;
+        Task popBack() {
+            --count;
+            return ring[(head + count) % ring.size()];
         }
 
-        return total;
-    }
+        Task popFront() {
+            Task t = ring[head];
+            head = (head + 1) % ring.size();
+            --count;
 
-    double getGapPositionProfit(const string& stockName) const {
-        auto it = gapPositions.find(stockName);
+            return t;
+        }
+    };
+
+    vector<unique_ptr<WorkQueue>> queues;   // [0]: 외부 스레드 제출용, [1..]: 작업자별
+    vector<thread> workers;
+    mutex sleepMtx;
+    condition_variable wakeCv;
+    atomic<size_t> queuedTasks;             // 큐에 넣기 전에 늘리고 꺼낸 뒤에 줄임 (항상 실제 개수 이상)
+    atomic<size_t> submitCursor;
+    bool stopping;
+
+    static size_t& currentQueueIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
 
-        if (it == gapPositions.end()) return 0.0;
+    bool popTask(size_t self, Task& task) {
+        // 1) 자기 큐 뒤에서
+        {
+            WorkQueue& q = *queues[self];
+            lock_guard<mutex> lock(q.mtx);
 
-        const Position& pos = it->second;
+            if (q.count > 0) {
+                task = q.popBack();
+                return true;
+            }
+        }
 
-        if (pos.quantity <= 0 || pos.avgBuyPrice <= 0.0) return 0.0;
+        // 2) 다른 큐 앞에서 훔치기
+        for (size_t k = 1; k < queues.size(); ++k) {
+            WorkQueue& q = *queues[(self + k) % queues.size()];
+            lock_guard<mutex> lock(q.mtx);
 
-        if (!pos.stock) return 0.0;
+            if (q.count > 0) {
+                task = q.popFront();
+                return true;
+            }
+        }
 
-        double currentPrice = pos.stock->getCurrentPrice();
+        return false;
+    }
 
-        // 수익률 = (현재가 - 평균 매수가) / 평균 매수가
-        double profitRate = (currentPrice - pos.avgBuyPrice) / pos.avgBuyPrice;
+    bool runOne(size_t self) {
+        Task task;
 
-        return profitRate;
-    }
-    
-    double getCash() const {
-        return cash;
-    }
+        if (!popTask(self, task)) return false;
 
-    const map<string, Position>& getGapPositions() const {
-        return gapPositions;
-    }
+        queuedTasks.fetch_sub(1);
+        task.job->invoke(task.job->fn, task.chunk);
+        task.job->latch->countDown();
 
-    int getGapPositionCount() const {
-        return static_cast<int>(gapPositions.size());
+        return true;
     }
 
-    void printGapPositionStatus() const {
-        if (gapPositions.empty()) return;
+    void workerLoop(size_t self) {
+        currentQueueIndex() = self;
 
-        cout << "\n[갭 포지션 현황]" << endl;
-        for (const auto& kv : gapPositions) {
-            const string& name = kv.first;
-            const Position& pos = kv.second;
-            if (!pos.stock || pos.quantity <= 0) continue;
+        while (true) {
+            if (runOne(self)) continue;
 
-            double currentPrice = pos.stock->getCurrentPrice();
-            double profitRate = (currentPrice - pos.avgBuyPrice) / pos.avgBuyPrice;
-            double profitAmount = (currentPrice - pos.avgBuyPrice) * pos.quantity;
+            unique_lock<mutex> lock(sleepMtx);
+            wakeCv.wait(lock, [&] { return stopping || queuedTasks.load() > 0; });
 
-            cout << "  " << name
-                 << " | 수량: " << pos.quantity
-                 << " | 매수가: " << fixed << setprecision(0) << pos.avgBuyPrice
-                 << " | 현재가: " << fixed << setprecision(0) << currentPrice
-                 << " | 수익률: " << fixed << setprecision(2) << (profitRate * 100) << "%"
-                 << " | 평가손익: " << fixed << setprecision(0) << profitAmount << endl;
+            if (stopping && queuedTasks.load() == 0) return;
         }
     }
 
-    void printPortfolioStatus() const {
-        if (portfolio.empty()) return;
+    void submit(const Task& task) {
+        size_t self = currentQueueIndex();
 
-        cout << "\n[포트폴리오 현황]" << endl;
-        double totalProfit = 0.0;
-        for (const auto& kv : portfolio) {
-            const string& name = kv.first;
-            const Position& pos = kv.second;
-            if (!pos.stock || pos.quantity <= 0) continue;
+        // 외부 스레드에서 제출된 작업은 작업자 큐에 골고루 분배
+        if (self == 0 && queues.size() > 1) {
+            self = 1 + submitCursor.fetch_add(1) % (queues.size() - 1);
+        }
+
+        // 보이기 전에 개수를 늘려 둠: 먼저 훔쳐 간 쪽이 줄여도 0 아래로 내려가지 않음
+        queuedTasks.fetch_add(1);
 
-            double currentPrice = pos.stock->getCurrentPrice();
-            double profitRate = (currentPrice - pos.avgBuyPrice) / pos.avgBuyPrice;
-            double profitAmount = (currentPrice - pos.avgBuyPrice) * pos.quantity;
-            totalProfit += profitAmount;
+        {
+            WorkQueue& q = *queues[self];
+            lock_guard<mutex> lock(q.mtx);
+            q.pushBack(task);
+        }
 
-            cout << "  " << name
-                 << " | 수량: " << pos.quantity
-                 << " | 매수가: " << fixed << setprecision(0) << pos.avgBuyPrice
-                 << " | 현재가: " << fixed << setprecision(0) << currentPrice
-                 << " | 수익률: " << fixed << setprecision(2) << (profitRate * 100) << "%"
-                 << " | 평가손익: " << fixed << setprecision(0) << profitAmount << endl;
+        {
+            lock_guard<mutex> lock(sleepMtx);
         }
-        cout << "  [포트폴리오 총 평가손익]: " << fixed << setprecision(0) << totalProfit << endl;
+
+        wakeCv.notify_one();
     }
-};
 
-// ============================================================
-// 팀원 C: MarketState 추상 클래스
-// ============================================================
-class MarketState {
 public:
-    virtual void handle(Trader& t, Market& m) = 0;
-    virtual string getStateName() const = 0;
-    virtual ~MarketState() {}
+    // threadCount: 호출 스레드를 포함한 전체 실행 스레드 수
+    explicit ThreadPool(size_t threadCount)
+        : queuedTasks(0), submitCursor(0), stopping(false) {
+        size_t workerCount = threadCount > 1 ? threadCount - 1 : 0;
+
+        for (size_t i = 0; i <= workerCount; ++i) {
+            queues.push_back(make_unique<WorkQueue>());
+        }
+
+        for (size_t i = 1; i <= workerCount; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(sleepMtx);
+            stopping = true;
+        }
+
+        wakeCv.notify_all();
+
+        for (thread& w : workers) {
+            w.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // 현재 스레드 번호: 0 = 풀 밖 (호출 스레드), 1 ~ size()-1 = 작업자
+    static size_t currentThreadIndex() { return currentQueueIndex(); }
+
+    template <typename Fn>
+    void parallelFor(size_t chunks, const Fn& fn) {
+        if (chunks == 0) return;
+
+        if (workers.empty() || chunks == 1) {
+            for (size_t c = 0; c < chunks; ++c) fn(c);
+            return;
+        }
+
+        Latch latch(chunks);
+        ChunkJob job{ [](const void* f, size_t c) { (*static_cast<const Fn*>(f))(c); }, &fn, &latch };
+
+        for (size_t c = 0; c < chunks; ++c) submit(Task{ &job, c });
+
+        // 남은 작업을 직접 처리하거나 훔쳐서 처리하고, 더 없으면 나머지가 끝날 때까지 잠듦
+        size_t self = currentQueueIndex();
+
+        while (!latch.done()) {
+            if (!runOne(self)) break;
+        }
+
+        latch.wait();
+    }
+};
+
+// ============================================================
+// 팀원 A: SymbolTable (종목명 -> 정수 ID 인턴 테이블)
+// ============================================================
+// addStock 시점에 종목명을 한 번만 해시하여 0부터 연속된 SymbolId를 부여한다.
+// 이후의 매매/평가 경로는 문자열 대신 SymbolId로 O(1) 조회한다.
+using SymbolId = int32_t;
+constexpr SymbolId INVALID_SYMBOL = -1;
+
+class SymbolTable {
+private:
+    unordered_map<string, SymbolId> ids;
+    vector<string> names;
+
+public:
+    // 이미 등록된 이름이면 기존 ID 반환
+    SymbolId intern(const string& name) {
+        auto it = ids.find(name);
+
+        if (it != ids.end()) return it->second;
+
+        SymbolId id = static_cast<SymbolId>(names.size());
+        ids.emplace(name, id);
+        names.push_back(name);
+
+        return id;
+    }
+
+    SymbolId find(const string& name) const {
+        auto it = ids.find(name);
+
+        return it == ids.end() ? INVALID_SYMBOL : it->second;
+    }
+
+    const string& name(SymbolId id) const { return names[id]; }
+
+    bool contains(SymbolId id) const { return id >= 0 && static_cast<size_t>(id) < names.size(); }
+
+    size_t size() const { return names.size(); }
+
+    void reserve(size_t n) {
+        ids.reserve(n);
+        names.reserve(n);
+    }
+};
+
+// ============================================================
+// 팀원 A: MarketBar (종목별 일봉: 종가, 거래량)
+// ============================================================
+// 과거 시세 파일의 레코드 형식 그대로이며, 재생 시 매핑된 메모리를 복사 없이 읽는다.
+struct MarketBar {
+    double price;
+    double volume;
+};
+
+static_assert(sizeof(MarketBar) == 16, "시세 파일 레코드는 16바이트 고정");
+
+// ============================================================
+// 팀원 A: StockTable (SoA 종목 저장소)
+// ============================================================
+// 종목 데이터를 필드별 연속 배열(Structure of Arrays)로 보관한다.
+// 일일 갱신과 시장 전체 집계는 포인터 추적 없이 배열을 순차 순회하는
+// 커널로 처리되어 컴파일러 자동 벡터화(SIMD)가 적용된다.
+class StockTable {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+public:
+    // 구간 집계값: 변동률의 (개수, 평균, 편차제곱합) + 거래량 합
+    struct Moments {
+        size_t count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        double volumeSum = 0.0;
+
+        // Chan et al. 병렬 Welford 병합
+        static Moments merge(const Moments& a, const Moments& b) {
+            if (a.count == 0) return b;
+            if (b.count == 0) return a;
+
+            Moments r;
+            r.count = a.count + b.count;
+            double delta = b.mean - a.mean;
+            r.mean = a.mean + delta * b.count / r.count;
+            r.m2 = a.m2 + b.m2 + delta * delta * (double(a.count) * b.count / r.count);
+            r.volumeSum = a.volumeSum + b.volumeSum;
+
+            return r;
+        }
+    };
+
+private:
+    static constexpr size_t SIMD_LANES = 4;   // 리덕션 누산기 레인 수
+
+    // 행 번호 == SymbolId. 같은 스냅샷에서 복원한 표끼리는 공유하고, 공유 중에 종목이 추가되면 그때 복사 (copy-on-write)
+    shared_ptr<SymbolTable> symbols;
+    ArenaVector<double> currentPrice;
+    ArenaVector<double> previousPrice;
+    ArenaVector<double> volume;
+    ArenaVector<double> averageVolume;
+
+    // 시장 전체 누적 집계 (가격/거래량이 바뀔 때마다 갱신)
+    Moments totals;
+
+    // 현재가가 바뀔 때마다 1 증가 (평가 캐시 무효화 판단용, 일괄 갱신은 커밋 때 한 번)
+    uint64_t priceVersion = 0;
+
+    // 최대 거래량 비율 토너먼트 트리: 잎 [leafCount, 2*leafCount), 루트 maxTree[1]
+    ArenaVector<double> maxTree;
+    size_t leafCount = 0;
+
+    void setLeaf(size_t i) {
+        maxTree[leafCount + i] = volumeRatio(volume[i], averageVolume[i]);
+    }
+
+    void updateMaxPath(size_t i) {
+        for (size_t node = (leafCount + i) / 2; node >= 1; node /= 2) {
+            maxTree[node] = max(maxTree[2 * node], maxTree[2 * node + 1]);
+        }
+    }
+
+    void rebuildInternalNodes() {
+        for (size_t node = leafCount - 1; node >= 1; --node) {
+            maxTree[node] = max(maxTree[2 * node], maxTree[2 * node + 1]);
+        }
+    }
+
+    // 종목 수가 잎 용량을 넘으면 트리를 2배로 키워 다시 구성
+    void growTree() {
+        size_t n = size();
+        if (n <= leafCount) return;
+
+        leafCount = max<size_t>(leafCount * 2, 2);
+        while (leafCount < n) leafCount *= 2;
+
+        maxTree.assign(2 * leafCount, 0.0);
+        for (size_t i = 0; i < n; ++i) setLeaf(i);
+        rebuildInternalNodes();
+    }
+
+    // 종목 수 n은 그대로, 한 종목의 변동률이 oldRate -> newRate로 바뀐 경우의 Welford 갱신
+    void replaceRate(double oldRate, double newRate) {
+        double oldMean = totals.mean;
+        totals.mean += (newRate - oldRate) / totals.count;
+        totals.m2 += (newRate - oldRate) * (newRate - totals.mean + oldRate - oldMean);
+    }
+
+public:
+    // arena가 있으면 가격/거래량 배열을 그 안에 둔다 (종목명 인턴 테이블은 힙)
+    explicit StockTable(Arena* arena = nullptr)
+        : symbols(make_shared<SymbolTable>()), currentPrice(ArenaAllocator<double>(arena)),
+          previousPrice(ArenaAllocator<double>(arena)), volume(ArenaAllocator<double>(arena)),
+          averageVolume(ArenaAllocator<double>(arena)), maxTree(ArenaAllocator<double>(arena)) {
+    }
+
+    // 새 종목이면 행을 추가하고, 이미 있는 종목명이면 기존 행 번호를 반환
+    size_t add(const string& name, double initPrice, double initVolume) {
+        if (symbols.use_count() > 1) {
+            SymbolId existing = symbols->find(name);
+            if (existing != INVALID_SYMBOL) return existing;
+
+            symbols = make_shared<SymbolTable>(*symbols);
+        }
+
+        SymbolId id = symbols->intern(name);
+
+        if (static_cast<size_t>(id) < currentPrice.size()) return id;
+
+        currentPrice.push_back(initPrice);
+        previousPrice.push_back(initPrice);
+        volume.push_back(initVolume);
+        averageVolume.push_back(initVolume);
+
+        // 신규 종목의 변동률은 0
+        Moments single;
+        single.count = 1;
+        single.volumeSum = initVolume;
+        totals = Moments::merge(totals, single);
+
+        if (size() > leafCount) {
+            growTree();
+        }
+
+        else {
+            setLeaf(id);
+            updateMaxPath(id);
+        }
+
+        return id;
+    }
+
+    size_t size() const { return currentPrice.size(); }
+
+    bool empty() const { return currentPrice.empty(); }
+
+    const SymbolTable& getSymbols() const { return *symbols; }
+
+    void reserve(size_t n) {
+        if (symbols.use_count() == 1) symbols->reserve(n);
+        currentPrice.reserve(n);
+        previousPrice.reserve(n);
+        volume.reserve(n);
+        averageVolume.reserve(n);
+    }
+
+    // ---------- 개별 종목 접근 (Stock 뷰에서 사용, 집계 O(1)/O(log n) 갱신) ----------
+    void updatePrice(size_t i, double newPrice) {
+        double oldRate = fluctuationRate(currentPrice[i], previousPrice[i]);
+
+        previousPrice[i] = currentPrice[i];
+        currentPrice[i] = newPrice;
+        ++priceVersion;
+
+        replaceRate(oldRate, fluctuationRate(currentPrice[i], previousPrice[i]));
+    }
+
+    void setVolume(size_t i, double newVolume) {
+        totals.volumeSum += newVolume - volume[i];
+
+        volume[i] = newVolume;
+        // EMA 평균 거래량
+        averageVolume[i] = averageVolume[i] * 0.95 + newVolume * 0.05;
+
+        setLeaf(i);
+        updateMaxPath(i);
+    }
+
+    // ---------- 장중 갱신 (전일가 = 전일 종가 유지) ----------
+
+    // 장 시작: 모든 종목의 전일가를 현재가(전일 종가)로 맞추고 변동률 집계를 다시 계산
+    void rollPreviousClose() {
+        copy(currentPrice.begin(), currentPrice.end(), previousPrice.begin());
+
+        totals = rangeMoments(0, size());
+    }
+
+    void setIntradayPrice(size_t i, double price) {
+        double oldRate = fluctuationRate(currentPrice[i], previousPrice[i]);
+
+        currentPrice[i] = price;
+        ++priceVersion;
+
+        replaceRate(oldRate, fluctuationRate(price, previousPrice[i]));
+    }
+
+    // 당일 누적 거래량 갱신. 평균 거래량은 전일까지의 EMA(baseAverage)에 당일 누적분을 반영한 잠정값.
+    void setIntradayVolume(size_t i, double dayVolume, double baseAverage) {
+        totals.volumeSum += dayVolume - volume[i];
+
+        volume[i] = dayVolume;
+        averageVolume[i] = baseAverage * 0.95 + dayVolume * 0.05;
+
+        setLeaf(i);
+        updateMaxPath(i);
+    }
+
+    const string& getName(size_t i) const { return symbols->name(static_cast<SymbolId>(i)); }
+
+    double getCurrentPrice(size_t i) const { return currentPrice[i]; }
+
+    double getPreviousPrice(size_t i) const { return previousPrice[i]; }
+
+    double getVolume(size_t i) const { return volume[i]; }
+
+    double getAverageVolume(size_t i) const { return averageVolume[i]; }
+
+    // 열 단위 일괄 읽기 (이력 기록, 이동 구간 지표용)
+    const double* priceData() const { return currentPrice.data(); }
+
+    const double* previousPriceData() const { return previousPrice.data(); }
+
+    const double* volumeData() const { return volume.data(); }
+
+    uint64_t getPriceVersion() const { return priceVersion; }
+
+    // ---------- 배열 단위 커널 ----------
+
+    // 일일 가격/거래량 갱신: [begin, end) 구간에 changeRate[i], volumeMultiplier[i]를 일괄 적용.
+    // 구간 집계를 반환하며, 모든 구간 처리 후 commitBulkUpdate()로 시장 집계에 반영한다.
+    Moments applyFluctuation(size_t begin, size_t end, const double* changeRate, const double* volumeMultiplier) {
+        double* cur = currentPrice.data();
+        double* prev = previousPrice.data();
+        double* vol = volume.data();
+        double* avg = averageVolume.data();
+        double* leaves = maxTree.data() + leafCount;
+
+        for (size_t i = begin; i < end; ++i) {
+            double oldPrice = cur[i];
+            double newPrice = oldPrice * (1.0 + changeRate[i]);
+            newPrice = newPrice < 0.01 ? 0.01 : newPrice;
+
+            double newVolume = avg[i] * volumeMultiplier[i];
+            double newAvg = avg[i] * 0.95 + newVolume * 0.05;
+
+            prev[i] = oldPrice;
+            cur[i] = newPrice;
+            vol[i] = newVolume;
+            avg[i] = newAvg;
+            leaves[i] = volumeRatio(newVolume, newAvg);
+        }
+
+        return rangeMoments(begin, end);
+    }
+
+    // 과거 시세 재생: [begin, end) 구간에 bars[i]의 가격/거래량을 updatePrice + setVolume과 같은 규칙으로 적용
+    Moments applyBars(size_t begin, size_t end, const MarketBar* bars) {
+        double* cur = currentPrice.data();
+        double* prev = previousPrice.data();
+        double* vol = volume.data();
+        double* avg = averageVolume.data();
+        double* leaves = maxTree.data() + leafCount;
+
+        for (size_t i = begin; i < end; ++i) {
+            double newVolume = bars[i].volume;
+            double newAvg = avg[i] * 0.95 + newVolume * 0.05;
+
+            prev[i] = cur[i];
+            cur[i] = bars[i].price;
+            vol[i] = newVolume;
+            avg[i] = newAvg;
+            leaves[i] = volumeRatio(newVolume, newAvg);
+        }
+
+        return rangeMoments(begin, end);
+    }
+
+    // 구간별 집계를 (구간 순서대로) 병합해 시장 집계를 교체하고 최대값 트리를 재구성
+    void commitBulkUpdate(const Moments* parts, size_t count) {
+        Moments merged;
+
+        for (size_t c = 0; c < count; ++c) {
+            merged = Moments::merge(merged, parts[c]);
+        }
+
+        totals = merged;
+        ++priceVersion;
+
+        if (leafCount > 0) rebuildInternalNodes();
+    }
+
+    // 변동률 = (현재가 - 전일가) / 전일가, 전일가가 0이면 0 (분기 없는 형태)
+    static double fluctuationRate(double cur, double prev) {
+        double rate = (cur - prev) / (prev != 0.0 ? prev : 1.0);
+        return prev != 0.0 ? rate : 0.0;
+    }
+
+    static double volumeRatio(double vol, double avg) {
+        double ratio = vol / (avg != 0.0 ? avg : 1.0);
+        return avg != 0.0 ? ratio : 0.0;
+    }
+
+    // 급락 후보 (selectFallers 결과)
+    struct Candidate {
+        double fall;
+        double volumeRatio;
+        size_t index;
+
+        // 하락률 큰 순 -> 거래량 비율 큰 순 -> 종목 순서.
+        // 힙/정렬 비교자는 엄격 약순서여야 하므로 허용 오차 없이 정확히 비교한다.
+        static bool better(const Candidate& a, const Candidate& b) {
+            if (a.fall != b.fall) return a.fall < b.fall;
+            if (a.volumeRatio != b.volumeRatio) return a.volumeRatio > b.volumeRatio;
+
+            return a.index < b.index;
+        }
+
+        // 크기 k의 힙(최하위가 top)에 후보 c를 넣고 힙 크기 반환. 다 넣은 뒤 sort_heap으로 순위 정렬
+        static size_t offer(Candidate* heap, size_t count, size_t k, const Candidate& c) {
+            if (count < k) {
+                heap[count++] = c;
+                push_heap(heap, heap + count, better);
+            }
+
+            else if (better(c, heap[0])) {
+                pop_heap(heap, heap + count, better);
+                heap[count - 1] = c;
+                push_heap(heap, heap + count, better);
+            }
+
+            return count;
+        }
+    };
+
+    // 하락률 < maxFall 이고 거래량 비율 > minVolumeRatio 인 종목 중 상위 k개를 out에 순위대로 기록, 개수 반환.
+    // 블록 단위로 조건을 분기 없이 계산해 통과한 인덱스만 압축한 뒤, 크기 k의 힙(최하위가 top)에 넣는다.
+    size_t selectFallers(double maxFall, double minVolumeRatio, size_t k, Candidate* out) const {
+        static constexpr size_t FILTER_BLOCK = 256;
+
+        if (k == 0) return 0;
+
+        const double* cur = currentPrice.data();
+        const double* prev = previousPrice.data();
+        const double* vol = volume.data();
+        const double* avg = averageVolume.data();
+        const size_t n = size();
+
+        size_t hits[FILTER_BLOCK];
+        size_t count = 0;
+
+        for (size_t base = 0; base < n; base += FILTER_BLOCK) {
+            size_t end = min(n, base + FILTER_BLOCK);
+            size_t passed = 0;
+
+            // 나눗셈 없이 비교: (cur - prev) / prev < maxFall, vol / avg > minVolumeRatio (prev, avg > 0)
+            for (size_t i = base; i < end; ++i) {
+                bool fell = (prev[i] > 0.0) & (cur[i] - prev[i] < maxFall * prev[i]);
+                bool surged = (avg[i] > 0.0) & (vol[i] > minVolumeRatio * avg[i]);
+
+                hits[passed] = i;
+                passed += static_cast<size_t>(fell & surged);
+            }
+
+            for (size_t h = 0; h < passed; ++h) {
+                size_t i = hits[h];
+                count = Candidate::offer(out, count, k, Candidate{ fluctuationRate(cur[i], prev[i]), volumeRatio(vol[i], avg[i]), i });
+            }
+        }
+
+        sort_heap(out, out + count, Candidate::better);
+
+        return count;
+    }
+
+    // [begin, end) 구간 집계 (캐시에 올라온 구간을 2-pass, 레인별 누산)
+    Moments rangeMoments(size_t begin, size_t end) const {
+        Moments r;
+        r.count = end - begin;
+        if (r.count == 0) return r;
+
+        const double* cur = currentPrice.data();
+        const double* prev = previousPrice.data();
+        const double* vol = volume.data();
+
+        double acc[SIMD_LANES] = {};
+        double volAcc[SIMD_LANES] = {};
+        size_t i = begin;
+
+        for (; i + SIMD_LANES <= end; i += SIMD_LANES) {
+            for (size_t l = 0; l < SIMD_LANES; ++l) {
+                acc[l] += fluctuationRate(cur[i + l], prev[i + l]);
+                volAcc[l] += vol[i + l];
+            }
+        }
+
+        double sum = 0.0;
+
+        for (size_t l = 0; l < SIMD_LANES; ++l) {
+            sum += acc[l];
+            r.volumeSum += volAcc[l];
+        }
+
+        for (; i < end; ++i) {
+            sum += fluctuationRate(cur[i], prev[i]);
+            r.volumeSum += vol[i];
+        }
+
+        r.mean = sum / r.count;
+
+        double sq[SIMD_LANES] = {};
+        i = begin;
+
+        for (; i + SIMD_LANES <= end; i += SIMD_LANES) {
+            for (size_t l = 0; l < SIMD_LANES; ++l) {
+                double diff = fluctuationRate(cur[i + l], prev[i + l]) - r.mean;
+                sq[l] += diff * diff;
+            }
+        }
+
+        for (size_t l = 0; l < SIMD_LANES; ++l) r.m2 += sq[l];
+
+        for (; i < end; ++i) {
+            double diff = fluctuationRate(cur[i], prev[i]) - r.mean;
+            r.m2 += diff * diff;
+        }
+
+        return r;
+    }
+
+    // ---------- 시장 집계 조회 (O(1)) ----------
+
+    // 전 종목 변동률의 표준편차 (모집단)
+    double volatility() const {
+        if (totals.count == 0) return 0.0;
+
+        return sqrt(max(0.0, totals.m2) / totals.count);
+    }
+
+    double volumeSum() const { return totals.volumeSum; }
+
+    double maxVolumeRatio() const {
+        return leafCount > 0 ? maxTree[1] : 0.0;
+    }
+};
+
+// ============================================================
+// 팀원 A: Stock 클래스
+// ============================================================
+// StockTable의 한 행을 가리키는 경량 뷰. 기존 인터페이스를 그대로 제공한다.
+class Stock {
+private:
+    StockTable* table;
+    size_t index;
+
+public:
+    Stock(StockTable* table, size_t index)
+        : table(table), index(index) {
+    }
+
+    void updatePrice(double newPrice) {
+        table->updatePrice(index, newPrice);
+    }
+
+    double getFluctuationRate() const {
+        // 비율 반환 (0.05 = 5%)
+        return StockTable::fluctuationRate(table->getCurrentPrice(index), table->getPreviousPrice(index));
+    }
+
+    void setVolume(double newVolume) {
+        table->setVolume(index, newVolume);
+    }
+
+    double getAverageVolume() const { return table->getAverageVolume(index); }
+
+    double getVolumeRatio() const {
+        return StockTable::volumeRatio(table->getVolume(index), table->getAverageVolume(index));
+    }
+
+    const string& getName() const { return table->getName(index); }
+
+    double getCurrentPrice() const { return table->getCurrentPrice(index); }
+
+    double getPreviousPrice() const { return table->getPreviousPrice(index); }
+
+    double getVolume() const { return table->getVolume(index); }
+
+    SymbolId getId() const { return static_cast<SymbolId>(index); }
+
+    const SymbolTable& getSymbols() const { return table->getSymbols(); }
+};
+
+// ============================================================
+// 공통: Logger (비동기 일괄 로깅)
+// ============================================================
+// 시뮬레이션 스레드는 고정 크기 이진 이벤트(LogEvent)만 링 버퍼에 넣고 즉시 돌아간다.
+// 백그라운드 스레드가 이벤트를 문자열로 변환(종목명 조회, 시각 변환 포함)하여
+// 큰 블록 단위로 stdout에 기록한다.
+// - 링 버퍼: 락 없는 유한 MPMC 큐 (Vyukov), 가득 차면 생산자가 양보하며 대기 (유실 없음)
+// - 로그 레벨: Silent(전부 생략) < Error(오류만, 헤드리스 실행) < Info(거래/상태 전환/일별 요약) < Verbose(종목/포지션 표, 기본값)
+// - 오류(Logger::error)는 같은 순서로 처리하되 stderr로 기록한다.
+// - 이벤트가 참조하는 SymbolTable은 flush() 전까지 살아 있어야 한다.
+enum class LogLevel : uint8_t {
+    Silent = 0,
+    Error = 1,
+    Info = 2,
+    Verbose = 3
+};
+
+enum class LogCode : uint8_t {
+    Text,               // text
+    Banner,
+    Seed,               // integer
+    TradingDays,        // integer
+    DayHeader,          // integer
+    MarketSummary,      // values: 변동성, 평균 거래량
+    StockLine,          // symbol, values: 현재가, 변동률, 거래량 비율, 평균 거래량
+    TransactionLine,    // raw: Transaction
+    PositionLine,       // symbol, integer: 수량, values: 매수가, 현재가, 수익률, 평가손익
+    PortfolioTotal,     // values: 총 평가손익
+    AssetLine,          // values: 현금, 전체 자산
+    TakeProfit,         // symbol, values: 수익률
+    StopLoss,           // symbol, values: 수익률
+    GapTradingBuy,      // symbol, integer: 수량, values: 가격, 하락률
+    ContrarianBuy,      // symbol, integer: 수량, values: 가격, 하락률
+    StateChange,        // text: 새 상태 이름
+    AutoTradeStatus,    // text: 상태 이름, values: 점수
+    HistorySummary,     // integer: 보존 일수, values: 메모리, 원본 크기 (바이트)
+    HistoryLine,        // symbol, integer: 일수, values: 시작가, 최종가, 최저가, 최고가
+    IntradayTrigger,    // symbol, integer: 시각 (자정 기준 분)
+    IntradaySummary,    // integer: 틱 수, values: 사건 전략 실행 횟수
+    IndicatorLine,      // integer: 구간 일수, values: 이동 평균, 변동성, 고점 대비 낙폭, 평균 가격 범위, 거래량 z
+    Error               // text: 메시지, raw: 세부 문자열 복사본 (char*, 출력 후 로그 스레드가 해제)
+};
+
+struct LogEvent {
+    static constexpr size_t MAX_VALUES = 6;
+
+    LogCode code = LogCode::Text;
+    SymbolId symbol = INVALID_SYMBOL;
+    int64_t integer = 0;
+    const char* text = nullptr;             // 정적 수명 문자열만 허용
+    const SymbolTable* symbols = nullptr;
+
+    union {
+        double values[MAX_VALUES];
+        alignas(8) unsigned char raw[MAX_VALUES * sizeof(double)];
+    };
+
+    LogEvent() : values{} {}
+};
+
+class Logger {
+private:
+    static constexpr size_t CAPACITY = 1 << 14;            // 이벤트 수 (2의 거듭제곱)
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;       // 한 번에 기록할 문자열 크기
+
+    struct Cell {
+        atomic<size_t> sequence;
+        LogEvent event;
+    };
+
+    unique_ptr<Cell[]> cells;
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) atomic<size_t> writtenPos;      // 출력까지 끝난 이벤트 수
+    size_t dequeuePos;                          // 소비자 스레드 전용
+    atomic<bool> stopping;
+    mutex flushMtx;
+    condition_variable flushCv;                 // writtenPos가 늘면 flush() 대기자를 깨움
+    thread consumer;
+
+    static atomic<int>& levelRef() {
+        static atomic<int> level(static_cast<int>(LogLevel::Verbose));
+        return level;
+    }
+
+    Logger()
+        : cells(new Cell[CAPACITY]), enqueuePos(0), writtenPos(0), dequeuePos(0), stopping(false) {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+
+        consumer = thread([this] { consumeLoop(); });
+    }
+
+    void push(const LogEvent& ev) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &cells[pos & (CAPACITY - 1)];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            }
+
+            else if (diff < 0) {
+                // 버퍼 가득 참 -> 소비자가 비울 때까지 양보
+                this_thread::yield();
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+
+            else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+
+        cell->event = ev;
+        cell->sequence.store(pos + 1, memory_order_release);
+    }
+
+    bool pop(LogEvent& ev) {
+        Cell* cell = &cells[dequeuePos & (CAPACITY - 1)];
+
+        if (cell->sequence.load(memory_order_acquire) != dequeuePos + 1) return false;
+
+        ev = cell->event;
+        cell->sequence.store(dequeuePos + CAPACITY, memory_order_release);
+        ++dequeuePos;
+
+        return true;
+    }
+
+    void writeOut(string& buffer) {
+        if (!buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), stdout);
+            buffer.clear();
+        }
+
+        fflush(stdout);
+        writtenPos.store(dequeuePos, memory_order_release);
+
+        {
+            lock_guard<mutex> lock(flushMtx);
+        }
+
+        flushCv.notify_all();
+    }
+
+    // 오류 이벤트: 앞서 모은 일반 출력을 먼저 내보낸 뒤 stderr로 기록
+    void writeError(const LogEvent& ev, string& buffer) {
+        if (!buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), stdout);
+            buffer.clear();
+        }
+
+        fflush(stdout);
+
+        char* detail;
+        memcpy(&detail, ev.raw, sizeof(detail));
+
+        string line = ev.text ? ev.text : "";
+        if (detail) line += detail;
+        line += '\n';
+
+        fwrite(line.data(), 1, line.size(), stderr);
+        fflush(stderr);
+
+        delete[] detail;
+    }
+
+    void consumeLoop() {
+        string buffer;
+        buffer.reserve(FLUSH_BYTES * 2);
+        LogEvent ev;
+
+        while (true) {
+            bool any = false;
+
+            while (pop(ev)) {
+                any = true;
+
+                if (ev.code == LogCode::Error) {
+                    writeError(ev, buffer);
+                    continue;
+                }
+
+                formatEvent(ev, buffer);
+
+                if (buffer.size() >= FLUSH_BYTES) {
+                    fwrite(buffer.data(), 1, buffer.size(), stdout);
+                    buffer.clear();
+                }
+            }
+
+            if (any) {
+                writeOut(buffer);
+                continue;
+            }
+
+            if (stopping.load(memory_order_acquire) && dequeuePos == enqueuePos.load(memory_order_acquire)) break;
+
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+
+        writeOut(buffer);
+    }
+
+    static void formatEvent(const LogEvent& ev, string& out);   // Transaction 정의 후 구현
+
+public:
+    ~Logger() {
+        stopping.store(true, memory_order_release);
+        consumer.join();
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    static void setLevel(LogLevel level) {
+        levelRef().store(static_cast<int>(level), memory_order_relaxed);
+    }
+
+    static LogLevel getLevel() {
+        return static_cast<LogLevel>(levelRef().load(memory_order_relaxed));
+    }
+
+    // 레벨 검사는 로그 인자를 계산하기 전에 호출하여 비용을 피한다.
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) <= levelRef().load(memory_order_relaxed) && level != LogLevel::Silent;
+    }
+
+    static void write(LogLevel level, const LogEvent& ev) {
+        if (!enabled(level)) return;
+
+        instance().push(ev);
+    }
+
+    static void write(LogLevel level, LogCode code, initializer_list<double> values = {}, int64_t integer = 0,
+                      SymbolId symbol = INVALID_SYMBOL, const SymbolTable* symbols = nullptr) {
+        if (!enabled(level)) return;
+
+        LogEvent ev;
+        ev.code = code;
+        ev.integer = integer;
+        ev.symbol = symbol;
+        ev.symbols = symbols;
+
+        size_t i = 0;
+        for (double v : values) {
+            if (i < LogEvent::MAX_VALUES) ev.values[i++] = v;
+        }
+
+        instance().push(ev);
+    }
+
+    static void text(LogLevel level, const char* literal) {
+        if (!enabled(level)) return;
+
+        LogEvent ev;
+        ev.code = LogCode::Text;
+        ev.text = literal;
+
+        instance().push(ev);
+    }
+
+    // 오류 메시지 (literal + 경로 등 세부 문자열). 세부 문자열은 복사해서 넘긴다.
+    static void error(const char* literal, const string& detail = string()) {
+        if (!enabled(LogLevel::Error)) return;
+
+        LogEvent ev;
+        ev.code = LogCode::Error;
+        ev.text = literal;
+
+        char* copy = nullptr;
+
+        if (!detail.empty()) {
+            copy = new char[detail.size() + 1];
+            memcpy(copy, detail.c_str(), detail.size() + 1);
+        }
+
+        memcpy(ev.raw, &copy, sizeof(copy));
+
+        write(LogLevel::Error, ev);
+    }
+
+    // 지금까지 넣은 이벤트가 모두 출력될 때까지 대기 (로그 스레드가 출력 후 깨움)
+    static void flush() {
+        Logger& logger = instance();
+        size_t target = logger.enqueuePos.load(memory_order_acquire);
+
+        unique_lock<mutex> lock(logger.flushMtx);
+        logger.flushCv.wait(lock, [&] { return logger.writtenPos.load(memory_order_acquire) >= target; });
+    }
+
+    static bool parseLevel(const string& name, LogLevel& level) {
+        if (name == "silent") level = LogLevel::Silent;
+        else if (name == "error") level = LogLevel::Error;
+        else if (name == "info") level = LogLevel::Info;
+        else if (name == "verbose") level = LogLevel::Verbose;
+        else return false;
+
+        return true;
+    }
+};
+
+ProfileExporter::ProfileExporter(string jsonPath, string prometheusPath)
+    : jsonPath(move(jsonPath)), prometheusPath(move(prometheusPath)) {
+    if (!Profiler::ENABLED && (!this->jsonPath.empty() || !this->prometheusPath.empty())) {
+        Logger::error("[경고] 프로브가 비활성화된 빌드입니다 (-DSTOCKSIM_PROFILE=1 로 다시 빌드)");
+    }
+}
+
+ProfileExporter::~ProfileExporter() {
+    if (!jsonPath.empty() && !Profiler::writeJson(jsonPath)) {
+        Logger::error("[오류] 프로파일 JSON을 쓸 수 없음: ", jsonPath);
+    }
+
+    if (!prometheusPath.empty() && !Profiler::writePrometheus(prometheusPath)) {
+        Logger::error("[오류] 프로파일 Prometheus 파일을 쓸 수 없음: ", prometheusPath);
+    }
+}
+
+// ============================================================
+// 공통: SimClock (가상 시뮬레이션 시계)
+// ============================================================
+// 시뮬레이션 시각(SimTime) = 0일차 00:00부터의 나노초. 시장이 일자/장중 틱을 진행하며 시계를 앞으로 옮기고,
+// 거래 기록과 포지션은 now()를 그대로 저장한다 (벽시계 시스템 콜 없음, 같은 시드면 같은 시각).
+// 사람이 읽는 형식("Day 3 15:30:00.000000000")으로의 변환은 출력 시점(로그 스레드)에서만 한다.
+using SimTime = int64_t;
+
+class SimClock {
+public:
+    static constexpr SimTime NS_PER_SECOND = 1000000000;
+    static constexpr SimTime NS_PER_MINUTE = 60 * NS_PER_SECOND;
+    static constexpr SimTime NS_PER_DAY = 24 * 60 * NS_PER_MINUTE;
+    static constexpr SimTime SESSION_OPEN = 9 * 60 * NS_PER_MINUTE;             // 09:00
+    static constexpr SimTime SESSION_CLOSE = (15 * 60 + 30) * NS_PER_MINUTE;    // 15:30
+
+private:
+    SimTime current = 0;
+
+public:
+    SimTime now() const { return current; }
+
+    // 시각은 뒤로 가지 않음 (같은 시각이면 그대로)
+    void advanceTo(SimTime t) { current = max(current, t); }
+
+    void reset(SimTime t = 0) { current = t; }
+
+    static SimTime at(uint64_t day, SimTime timeOfDay) { return static_cast<SimTime>(day) * NS_PER_DAY + timeOfDay; }
+
+    // day일 장중 진행률 fraction (0 ~ 1)의 시각
+    static SimTime sessionTime(uint64_t day, double fraction) {
+        return at(day, SESSION_OPEN + static_cast<SimTime>(fraction * static_cast<double>(SESSION_CLOSE - SESSION_OPEN)));
+    }
+
+    // "Day d HH:MM:SS.nnnnnnnnn" 형식으로 buf에 기록
+    static void format(SimTime t, char* buf, size_t size) {
+        SimTime day = t / NS_PER_DAY;
+        SimTime rest = t % NS_PER_DAY;
+
+        snprintf(buf, size, "Day %lld %02lld:%02lld:%02lld.%09lld", static_cast<long long>(day),
+                 static_cast<long long>(rest / (60 * NS_PER_MINUTE)), static_cast<long long>(rest / NS_PER_MINUTE % 60),
+                 static_cast<long long>(rest / NS_PER_SECOND % 60), static_cast<long long>(rest % NS_PER_SECOND));
+    }
+};
+
+// ============================================================
+// 팀원 A: Transaction 클래스
+// ============================================================
+// 거래 구분 (명세서의 type 문자열을 열거형으로 저장, 출력 시 한국어 라벨로 변환)
+enum class TradeType : uint8_t {
+    Buy,        // 매수
+    Sell,       // 청산
+    GapBuy,     // 갭 매수
+    GapSell     // 갭 청산
+};
+
+inline const char* tradeTypeLabel(TradeType type) {
+    switch (type) {
+    case TradeType::Buy:     return "매수";
+    case TradeType::Sell:    return "청산";
+    case TradeType::GapBuy:  return "갭 매수";
+    case TradeType::GapSell: return "갭 청산";
+    }
+
+    return "?";
+}
+
+// 고정 폭(48바이트) 레코드. 문자열 없이 바이트 그대로 저널 파일에 기록된다.
+// 총액(totalAmount)은 저장하지 않고 가격 x 수량으로 계산한다.
+class Transaction {
+private:
+    SimTime timestamp;      // 가상 시각 (SimClock)
+    double price;
+    double profitRate;      // 청산 시 수익률 (매수 시에는 0)
+    double profitAmount;    // 청산 시 손익 금액
+    SymbolId symbol;
+    int32_t quantity;
+    TradeType type;
+    bool isGapTrade;
+    bool isPartialFill;     // 주문 수량 중 일부만 체결됨 (quantity = 체결 수량)
+
+public:
+    Transaction(SymbolId symbol, TradeType type, int quantity, double price, bool isGapTrade, SimTime timestamp)
+        : timestamp(timestamp), price(price), profitRate(0.0), profitAmount(0.0),
+          symbol(symbol), quantity(quantity), type(type), isGapTrade(isGapTrade), isPartialFill(false) {
+    }
+
+    // 종목명 조회와 시각 변환은 로그 스레드에서 출력 시점에 수행
+    void printLog(const SymbolTable& symbols) const {
+        if (!Logger::enabled(LogLevel::Info)) return;
+
+        LogEvent ev;
+        ev.code = LogCode::TransactionLine;
+        ev.symbols = &symbols;
+        memcpy(ev.raw, this, sizeof(Transaction));
+
+        Logger::write(LogLevel::Info, ev);
+    }
+
+    void setProfitInfo(double rate, double amount) {
+        profitRate = rate;
+        profitAmount = amount;
+    }
+
+    TradeType getType() const { return type; }
+
+    void setType(TradeType t) { type = t; }
+
+    bool isClose() const { return type == TradeType::Sell || type == TradeType::GapSell; }
+
+    void setGapTradeFlag(bool flag) { isGapTrade = flag; }
+
+    void setPartialFill(bool flag) { isPartialFill = flag; }
+
+    bool getIsPartialFill() const { return isPartialFill; }
+
+    SymbolId getSymbolId() const { return symbol; }
+
+    int getQuantity() const { return quantity; }
+
+    double getPrice() const { return price; }
+
+    double getTotalAmount() const { return price * quantity; }
+
+    bool getIsGapTrade() const { return isGapTrade; }
+
+    SimTime getTimestamp() const { return timestamp; }
+
+    double getProfitRate() const { return profitRate; }
+
+    double getProfitAmount() const { return profitAmount; }
+};
+
+static_assert(is_trivially_copyable<Transaction>::value, "Transaction은 저널에 바이트 단위로 기록됨");
+static_assert(sizeof(Transaction) == 48, "저널 레코드 형식(버전 3)은 48바이트 고정");
+
+// ============================================================
+// Logger 이벤트 -> 문자열 변환 (로그 스레드에서 실행)
+// ============================================================
+inline void appendf(string& out, const char* fmt, ...) {
+    char buf[512];
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (n > 0) out.append(buf, min(static_cast<size_t>(n), sizeof(buf) - 1));
+}
+
+void Logger::formatEvent(const LogEvent& ev, string& out) {
+    const double* v = ev.values;
+    const char* name = (ev.symbols && ev.symbols->contains(ev.symbol)) ? ev.symbols->name(ev.symbol).c_str() : "";
+
+    switch (ev.code) {
+    case LogCode::Text:
+        out += ev.text;
+        out += '\n';
+        break;
+
+    case LogCode::Banner:
+        out += "==============================\n"
+               "     [주식 거래 프로그램]     \n"
+               "==============================\n\n";
+        break;
+
+    case LogCode::Seed:
+        appendf(out, "[난수 시드]: %llu\n\n", static_cast<unsigned long long>(ev.integer));
+        break;
+
+    case LogCode::TradingDays:
+        appendf(out, "[자동매매 %lld일]\n", static_cast<long long>(ev.integer));
+        break;
+
+    case LogCode::DayHeader:
+        appendf(out, "--- [Day %lld]---\n", static_cast<long long>(ev.integer));
+        break;
+
+    case LogCode::MarketSummary:
+        appendf(out, "\n====== 시장 현황 ======\n시장 변동성: %.4f%%\n평균 거래량: %.0f\n",
+                v[0] * 100, v[1]);
+        break;
+
+    case LogCode::StockLine:
+        appendf(out, "%s | 현재가: %.2f | 변동성: %.2f%% | 거래량 비율: %.2f%% | 평균 거래량: %lld\n",
+                name, v[0], v[1] * 100, v[2] * 100, static_cast<long long>(v[3]));
+        break;
+
+    case LogCode::TransactionLine: {
+        Transaction t(INVALID_SYMBOL, TradeType::Buy, 0, 0.0, false, 0);
+        memcpy(static_cast<void*>(&t), ev.raw, sizeof(Transaction));
+
+        char stamp[48];
+        SimClock::format(t.getTimestamp(), stamp, sizeof(stamp));
+
+        appendf(out, "[%s] %s%s %s | 수량: %d | 가격: %.2f | 총액: %.2f",
+                stamp, t.getIsGapTrade() ? "[갭] " : "", tradeTypeLabel(t.getType()),
+                !ev.symbols ? "" : ev.symbols->contains(t.getSymbolId()) ? ev.symbols->name(t.getSymbolId()).c_str() : "?",
+                t.getQuantity(), t.getPrice(), t.getTotalAmount());
+
+        // 청산 거래인 경우 수익률 표시
+        if (t.isClose() && (t.getProfitRate() != 0.0 || t.getProfitAmount() != 0.0)) {
+            appendf(out, " | 수익률: %.2f%% | 손익: %.0f", t.getProfitRate() * 100, t.getProfitAmount());
+        }
+
+        if (t.getIsPartialFill()) out += " | 부분 체결";
+
+        out += '\n';
+        break;
+    }
+
+    case LogCode::PositionLine:
+        appendf(out, "  %s | 수량: %lld | 매수가: %.0f | 현재가: %.0f | 수익률: %.2f%% | 평가손익: %.0f\n",
+                name, static_cast<long long>(ev.integer), v[0], v[1], v[2] * 100, v[3]);
+        break;
+
+    case LogCode::PortfolioTotal:
+        appendf(out, "  [포트폴리오 총 평가손익]: %.0f\n", v[0]);
+        break;
+
+    case LogCode::AssetLine:
+        appendf(out, "[현금]: %.0f | [전체 자산 평가]: %.0f\n\n", v[0], v[1]);
+        break;
+
+    case LogCode::TakeProfit:
+        appendf(out, "[NormalState] 갭 포지션 목표 수익 달성: %s (수익률: %.2f%%) 청산 수행\n", name, v[0] * 100);
+        break;
+
+    case LogCode::StopLoss:
+        appendf(out, "[NormalState] 갭 포지션 손절: %s (수익률: %.2f%%) 손절 수행\n", name, v[0] * 100);
+        break;
+
+    case LogCode::GapTradingBuy:
+        appendf(out, "[DisruptedState] 갭 트레이딩 매수: %s | 수량: %lld | 가격: %.2f | 하락률: %.2f%%\n",
+                name, static_cast<long long>(ev.integer), v[0], v[1] * 100);
+        break;
+
+    case LogCode::ContrarianBuy:
+        appendf(out, "[DisruptedState] 역발상 매수: %s | 수량: %lld | 가격: %.2f | 하락률: %.2f%%\n",
+                name, static_cast<long long>(ev.integer), v[0], v[1] * 100);
+        break;
+
+    case LogCode::StateChange:
+        appendf(out, "[DisruptionDetector] 상태 전환 -> %s\n", ev.text);
+        break;
+
+    case LogCode::AutoTradeStatus:
+        appendf(out, "[자동매매] 현재 상태: %s | DisruptionScore: %.2f\n", ev.text, v[0]);
+        break;
+
+    case LogCode::HistorySummary:
+        appendf(out, "[가격 이력] 보존: %lld일 | 메모리: %.1f KB (원본 %.1f KB)\n",
+                static_cast<long long>(ev.integer), v[0] / 1024, v[1] / 1024);
+        break;
+
+    case LogCode::IntradayTrigger:
+        appendf(out, "[장중 %02lld:%02lld] %s 이벤트 -> 전략 실행\n",
+                static_cast<long long>(ev.integer / 60), static_cast<long long>(ev.integer % 60), name);
+        break;
+
+    case LogCode::IntradaySummary:
+        appendf(out, "\n[장중 시뮬레이션] 틱: %lld | 사건 전략 실행: %.0f회\n", static_cast<long long>(ev.integer), v[0]);
+        break;
+
+    case LogCode::HistoryLine:
+        appendf(out, "  %s | %lld일 | 시작: %.2f | 최종: %.2f | 최저: %.2f | 최고: %.2f\n",
+                name, static_cast<long long>(ev.integer), v[0], v[1], v[2], v[3]);
+        break;
+
+    case LogCode::IndicatorLine:
+        appendf(out, "  └ %lld일 평균: %.2f | 변동성: %.2f%% | 고점 대비: %.2f%% | 가격 범위: %.2f | 거래량 z: %.2f\n",
+                static_cast<long long>(ev.integer), v[0], v[1] * 100, v[2] * 100, v[3], v[4]);
+        break;
+
+    case LogCode::Error:    // 로그 스레드가 writeError로 stderr에 따로 기록
+        break;
+    }
+}
+
+// ============================================================
+// 팀원 A: TransactionJournal (추가 전용 바이너리 거래 저널)
+// ============================================================
+// [Header 32바이트][종목명 블록][Transaction 48바이트 x count] 형식의 메모리 매핑 파일.
+// 레코드는 SymbolId만 담으므로 파일 저널은 기록 당시 종목 구성(이름 목록)을 함께 저장한다.
+// - open(path, symbols): 파일에 매핑. 기존 저널은 종목 구성이 같을 때만 이어서 기록 (다르면 거부)
+//   열지 않으면 종목명 블록 없이 같은 형식의 힙 버퍼 사용
+// - append(): 끝에 레코드를 복사, 용량이 부족하면 2배로 늘려 다시 매핑(힙 버퍼는 재할당)
+// - forEach(): 매핑된 레코드를 순차 스트리밍 (전체를 별도 메모리로 읽어들이지 않음)
+class TransactionJournal {
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t count;
+        uint32_t symbolCount;   // 종목명 블록의 종목 수 (메모리 저널은 0)
+        uint32_t namesBytes;    // 종목명 블록 크기 (NUL 구분, 8바이트 단위로 패딩)
+    };
+
+    static_assert(sizeof(Header) == 32, "저널 헤더는 32바이트 고정");
+
+    static constexpr char MAGIC[8] = { 'T', 'X', 'J', 'R', 'N', 'L', '\0', '\0' };
+    static constexpr uint32_t VERSION = 4;     // 2: 부분 체결 플래그 추가, 3: 시각을 가상 시각(나노초)으로, 4: 종목명 블록
+    static constexpr size_t INITIAL_CAPACITY = 1024;       // 파일 저널 초기 레코드 수
+    static constexpr size_t MEMORY_INITIAL_CAPACITY = 64;  // 메모리 저널 초기 레코드 수 (경로별 Market이 많은 배치 실행 고려)
+
+    int fd;
+    bool readOnly;
+    char* base;
+    size_t mappedBytes;
+    size_t recordOffset;    // 헤더 + 종목명 블록
+    Arena* arena;           // 메모리 저널 버퍼를 둘 Arena (nullptr이면 힙)
+
+    Header* header() const { return reinterpret_cast<Header*>(base); }
+
+    Transaction* records() const { return reinterpret_cast<Transaction*>(base + recordOffset); }
+
+    size_t capacity() const {
+        return mappedBytes > recordOffset ? (mappedBytes - recordOffset) / sizeof(Transaction) : 0;
+    }
+
+    size_t bytesFor(size_t records) const {
+        return recordOffset + records * sizeof(Transaction);
+    }
+
+    static size_t namesBlockBytes(const SymbolTable& symbols) {
+        size_t bytes = 0;
+        for (size_t i = 0; i < symbols.size(); ++i) bytes += symbols.name(static_cast<SymbolId>(i)).size() + 1;
+
+        return (bytes + alignof(Transaction) - 1) / alignof(Transaction) * alignof(Transaction);
+    }
+
+    void initHeader() {
+        memcpy(header()->magic, MAGIC, sizeof(MAGIC));
+        header()->version = VERSION;
+        header()->recordSize = sizeof(Transaction);
+        header()->count = 0;
+        header()->symbolCount = 0;
+        header()->namesBytes = 0;
+    }
+
+    void writeNames(const SymbolTable& symbols) {
+        char* cursor = base + sizeof(Header);
+        memset(cursor, 0, recordOffset - sizeof(Header));
+
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            const string& name = symbols.name(static_cast<SymbolId>(i));
+            memcpy(cursor, name.c_str(), name.size() + 1);
+            cursor += name.size() + 1;
+        }
+
+        header()->symbolCount = static_cast<uint32_t>(symbols.size());
+        header()->namesBytes = static_cast<uint32_t>(recordOffset - sizeof(Header));
+    }
+
+    // 저장된 종목명 블록이 현재 종목 구성과 같은지 (순서 = SymbolId)
+    bool namesMatch(const SymbolTable& symbols) const {
+        if (header()->symbolCount != symbols.size()) return false;
+
+        const char* cursor = base + sizeof(Header);
+        const char* limit = base + recordOffset;
+
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            const char* end = static_cast<const char*>(memchr(cursor, '\0', static_cast<size_t>(limit - cursor)));
+
+            if (!end || symbols.name(static_cast<SymbolId>(i)).compare(0, string::npos, cursor, static_cast<size_t>(end - cursor)) != 0) {
+                return false;
+            }
+
+            cursor = end + 1;
+        }
+
+        return true;
+    }
+
+    // 레코드 용량을 newCapacity로 늘려 다시 매핑
+    bool grow(size_t newCapacity) {
+        size_t newBytes = bytesFor(newCapacity);
+
+        if (fd >= 0) {
+            if (ftruncate(fd, static_cast<off_t>(newBytes)) != 0) return false;
+
+            void* p = mmap(nullptr, newBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) return false;
+
+            if (base) munmap(base, mappedBytes);
+
+            base = static_cast<char*>(p);
+            mappedBytes = newBytes;
+
+            return true;
+        }
+
+        // 파일 없이 사용하는 경우: 시스템 호출 없는 힙(또는 Arena) 버퍼. Arena의 옛 버퍼는 reset 때 함께 회수.
+        char* p = arena ? static_cast<char*>(arena->allocate(newBytes, alignof(Transaction))) : new char[newBytes];
+
+        if (base) {
+            memcpy(p, base, bytesFor(size()));
+            if (!arena) delete[] base;
+        }
+
+        else {
+            memset(p, 0, sizeof(Header));
+        }
+
+        base = p;
+        mappedBytes = newBytes;
+
+        if (header()->recordSize == 0) initHeader();
+
+        return true;
+    }
+
+public:
+    explicit TransactionJournal(Arena* arena = nullptr)
+        : fd(-1), readOnly(false), base(nullptr), mappedBytes(0), recordOffset(sizeof(Header)), arena(arena) {
+    }
+
+    ~TransactionJournal() {
+        close();
+    }
+
+    TransactionJournal(const TransactionJournal&) = delete;
+    TransactionJournal& operator=(const TransactionJournal&) = delete;
+
+    // 파일 저널 열기. 형식과 종목 구성이 맞는 기존 파일이면 이어쓰기(또는 읽기 전용)로 연다.
+    bool open(const string& path, const SymbolTable& symbols, bool readOnlyMode = false) {
+        close();
+
+        fd = ::open(path.c_str(), readOnlyMode ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+        if (fd < 0) return false;
+
+        readOnly = readOnlyMode;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close();
+            return false;
+        }
+
+        size_t fileBytes = static_cast<size_t>(st.st_size);
+
+        if (fileBytes == 0) {
+            recordOffset = sizeof(Header) + namesBlockBytes(symbols);
+
+            if (readOnly || recordOffset - sizeof(Header) > UINT32_MAX || !grow(INITIAL_CAPACITY)) {
+                close();
+                return false;
+            }
+
+            initHeader();
+            writeNames(symbols);
+
+            return true;
+        }
+
+        void* p = mmap(nullptr, fileBytes, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+
+        if (p == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        base = static_cast<char*>(p);
+        mappedBytes = fileBytes;
+
+        if (fileBytes < sizeof(Header) || memcmp(header()->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header()->version != VERSION || header()->recordSize != sizeof(Transaction) ||
+            header()->namesBytes > fileBytes - sizeof(Header) || header()->namesBytes % alignof(Transaction) != 0) {
+            close();
+            return false;
+        }
+
+        recordOffset = sizeof(Header) + header()->namesBytes;
+
+        // 다른 종목 구성으로 기록된 저널은 SymbolId가 가리키는 종목이 달라지므로 이어쓰지 않음
+        if (header()->count > (fileBytes - recordOffset) / sizeof(Transaction) || !namesMatch(symbols)) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // 매핑 해제. 파일 저널은 실제 기록된 길이로 잘라낸다.
+    void close() {
+        size_t used = base ? bytesFor(size()) : 0;
+
+        if (base && fd >= 0) munmap(base, mappedBytes);
+        else if (!arena) delete[] base;
+
+        if (fd >= 0) {
+            if (!readOnly && used > 0 && ftruncate(fd, static_cast<off_t>(used)) != 0) {
+                // 잘라내기 실패 시에도 헤더의 count가 유효 길이를 나타냄
+            }
+
+            ::close(fd);
+        }
+
+        fd = -1;
+        readOnly = false;
+        base = nullptr;
+        mappedBytes = 0;
+        recordOffset = sizeof(Header);
+    }
+
+    bool isFileBacked() const { return fd >= 0; }
+
+    bool append(const Transaction& t) {
+        if (readOnly) return false;
+
+        if (size() >= capacity()) {
+            size_t initial = fd >= 0 ? INITIAL_CAPACITY : MEMORY_INITIAL_CAPACITY;
+
+            if (!grow(max(initial, capacity() * 2))) return false;
+        }
+
+        memcpy(&records()[size()], &t, sizeof(Transaction));
+        ++header()->count;
+
+        return true;
+    }
+
+    size_t size() const { return base ? static_cast<size_t>(header()->count) : 0; }
+
+    bool empty() const { return size() == 0; }
+
+    const Transaction& operator[](size_t i) const { return records()[i]; }
+
+    // 레코드를 순서대로 스트리밍 (운영체제에 순차 접근 힌트 전달)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        if (empty()) return;
+
+        if (fd >= 0) madvise(base, mappedBytes, MADV_SEQUENTIAL);
+
+        const Transaction* r = records();
+        const size_t n = size();
+
+        for (size_t i = 0; i < n; ++i) {
+            fn(r[i]);
+        }
+    }
+
+    // 디스크 반영
+    void sync() {
+        if (fd >= 0 && base) msync(base, mappedBytes, MS_SYNC);
+    }
+};
+
+// ============================================================
+// 팀원 A: OrderBook (종목별 지정가 주문장, 가격-시간 우선 체결)
+// ============================================================
+// 가격은 호가 단위(tickSize)의 정수 배수로 다루며, 기준 호가(baseTick)부터 LEVELS개 호가를 배열로 둔다.
+// 호가마다 주문 노드의 이중 연결 FIFO(시간 우선)를 두고, 주문 노드는 풀에서 재사용한다 (자유 목록).
+// OrderId = (세대 << 32) | 노드 번호 -> 취소는 해시 조회 없이 O(1), 재사용된 노드의 옛 ID는 세대 불일치로 거부.
+enum class OrderSide : uint8_t {
+    Buy,
+    Sell
+};
+
+using OrderId = uint64_t;
+static constexpr OrderId INVALID_ORDER = ~OrderId(0);
+
+class OrderBook {
+public:
+    static constexpr int32_t LEVELS = 512;
+
+    // 체결 1건 (상대 주문 기준)
+    struct Fill {
+        OrderId maker;
+        uint32_t makerOwner;
+        int32_t quantity;
+        double price;
+    };
+
+private:
+    struct Order {
+        int32_t prev;
+        int32_t next;
+        int32_t level;          // -1이면 빈 노드
+        int32_t quantity;
+        uint32_t owner;
+        uint32_t generation;
+        OrderSide side;
+    };
+
+    struct Level {
+        int32_t head = -1;
+        int32_t tail = -1;
+        int64_t quantity = 0;
+    };
+
+    vector<Order> pool;
+    int32_t freeHead;
+    vector<Level> levels;
+    int64_t baseTick;
+    double tickSize;
+    int32_t bestBid;            // 매수 최우선 호가 (-1이면 없음)
+    int32_t bestAsk;            // 매도 최우선 호가 (LEVELS면 없음)
+
+    int32_t allocateNode() {
+        if (freeHead >= 0) {
+            int32_t node = freeHead;
+            freeHead = pool[node].next;
+            return node;
+        }
+
+        pool.push_back(Order{ -1, -1, -1, 0, 0, 0, OrderSide::Buy });
+
+        return static_cast<int32_t>(pool.size() - 1);
+    }
+
+    void releaseNode(int32_t node) {
+        Order& o = pool[node];
+        o.level = -1;
+        o.quantity = 0;
+        ++o.generation;
+        o.next = freeHead;
+        freeHead = node;
+    }
+
+    void unlink(int32_t node) {
+        Order& o = pool[node];
+        Level& level = levels[o.level];
+
+        if (o.prev >= 0) pool[o.prev].next = o.next;
+        else level.head = o.next;
+
+        if (o.next >= 0) pool[o.next].prev = o.prev;
+        else level.tail = o.prev;
+    }
+
+    // 빈 호가가 생겼을 때 최우선 호가 재탐색
+    void refreshBest() {
+        while (bestBid >= 0 && levels[bestBid].head < 0) --bestBid;
+        while (bestAsk < LEVELS && levels[bestAsk].head < 0) ++bestAsk;
+    }
+
+    // side 방향 주문이 limitLevel(포함)까지 반대편 호가를 소진. 금액 상한(maxNotional)을 넘는 수량은 체결하지 않는다.
+    int32_t match(OrderSide side, int32_t limitLevel, int32_t quantity, double maxNotional, vector<Fill>& fills) {
+        int32_t remaining = quantity;
+        double spent = 0.0;
+
+        while (remaining > 0) {
+            int32_t lv = side == OrderSide::Buy ? bestAsk : bestBid;
+
+            if (side == OrderSide::Buy ? (lv >= LEVELS || lv > limitLevel) : (lv < 0 || lv < limitLevel)) break;
+
+            Level& level = levels[lv];
+            double price = priceOf(lv);
+            int32_t affordable = static_cast<int32_t>(min<double>(remaining, floor((maxNotional - spent) / price)));
+
+            if (affordable <= 0) break;
+
+            while (level.head >= 0 && affordable > 0) {
+                int32_t node = level.head;
+                Order& maker = pool[node];
+                int32_t take = min(affordable, maker.quantity);
+
+                fills.push_back(Fill{ idOf(node), maker.owner, take, price });
+
+                maker.quantity -= take;
+                level.quantity -= take;
+                remaining -= take;
+                affordable -= take;
+                spent += take * price;
+
+                if (maker.quantity == 0) {
+                    unlink(node);
+                    releaseNode(node);
+                }
+            }
+
+            if (level.head >= 0) break;     // 금액 상한 도달
+
+            refreshBest();
+        }
+
+        return quantity - remaining;
+    }
+
+    OrderId idOf(int32_t node) const {
+        return (static_cast<OrderId>(pool[node].generation) << 32) | static_cast<uint32_t>(node);
+    }
+
+public:
+    OrderBook()
+        : freeHead(-1), levels(LEVELS), baseTick(0), tickSize(1.0), bestBid(-1), bestAsk(LEVELS) {
+    }
+
+    // 모든 주문을 지우고 centerPrice가 가운데 오도록 호가 창을 다시 잡음 (이전 OrderId는 모두 무효)
+    void reset(double centerPrice, double tick) {
+        tickSize = tick > 0.0 ? tick : 1.0;
+        baseTick = llround(centerPrice / tickSize) - LEVELS / 2;
+
+        fill(levels.begin(), levels.end(), Level());
+        freeHead = -1;
+
+        for (int32_t node = static_cast<int32_t>(pool.size()) - 1; node >= 0; --node) {
+            if (pool[node].level >= 0) releaseNode(node);
+            else {
+                pool[node].next = freeHead;
+                freeHead = node;
+            }
+        }
+
+        bestBid = -1;
+        bestAsk = LEVELS;
+    }
+
+    // 가격 <-> 호가 배열 위치 (창 밖이면 -1 또는 LEVELS 이상)
+    int32_t levelOf(double price) const {
+        return static_cast<int32_t>(max<int64_t>(-1, min<int64_t>(LEVELS, llround(price / tickSize) - baseTick)));
+    }
+
+    double priceOf(int32_t level) const { return (baseTick + level) * tickSize; }
+
+    double getTickSize() const { return tickSize; }
+
+    // 지정가 주문: 먼저 반대편과 체결하고 남은 수량을 호가에 쌓음. 쌓인 주문 ID 반환 (전량 체결/창 밖이면 INVALID_ORDER).
+    OrderId addLimit(OrderSide side, double price, int32_t quantity, uint32_t owner, vector<Fill>& fills) {
+        int32_t lv = levelOf(price);
+
+        if (quantity <= 0 || lv < 0 || lv >= LEVELS) return INVALID_ORDER;
+
+        quantity -= match(side, lv, quantity, numeric_limits<double>::infinity(), fills);
+
+        if (quantity == 0) return INVALID_ORDER;
+
+        int32_t node = allocateNode();
+        Order& o = pool[node];
+        Level& level = levels[lv];
+
+        o.level = lv;
+        o.quantity = quantity;
+        o.owner = owner;
+        o.side = side;
+        o.next = -1;
+        o.prev = level.tail;
+
+        if (level.tail >= 0) pool[level.tail].next = node;
+        else level.head = node;
+
+        level.tail = node;
+        level.quantity += quantity;
+
+        if (side == OrderSide::Buy) bestBid = max(bestBid, lv);
+        else bestAsk = min(bestAsk, lv);
+
+        return idOf(node);
+    }
+
+    // 시장가 주문 (즉시 체결 후 잔량 취소). 체결 금액 합계가 maxNotional을 넘지 않는 만큼만 체결. 체결 수량 반환.
+    int32_t marketOrder(OrderSide side, int32_t quantity, double maxNotional, vector<Fill>& fills) {
+        if (quantity <= 0) return 0;
+
+        return match(side, side == OrderSide::Buy ? LEVELS - 1 : 0, quantity, maxNotional, fills);
+    }
+
+    bool cancel(OrderId id) {
+        uint32_t node = static_cast<uint32_t>(id);
+
+        if (node >= pool.size()) return false;
+
+        Order& o = pool[node];
+
+        if (o.level < 0 || o.generation != static_cast<uint32_t>(id >> 32)) return false;
+
+        levels[o.level].quantity -= o.quantity;
+        unlink(static_cast<int32_t>(node));
+        releaseNode(static_cast<int32_t>(node));
+        refreshBest();
+
+        return true;
+    }
+
+    bool hasBid() const { return bestBid >= 0; }
+
+    bool hasAsk() const { return bestAsk < LEVELS; }
+
+    double bestBidPrice() const { return hasBid() ? priceOf(bestBid) : 0.0; }
+
+    double bestAskPrice() const { return hasAsk() ? priceOf(bestAsk) : 0.0; }
+
+    // 가격 호가의 잔량 합계
+    int64_t depthAt(double price) const {
+        int32_t lv = levelOf(price);
+        return (lv < 0 || lv >= LEVELS) ? 0 : levels[lv].quantity;
+    }
+};
+
+// ============================================================
+// 팀원 A: PriceHistory (종목별 일별 가격/거래량 이력, 열 단위 압축)
+// ============================================================
+// 일자를 블록(최대 BLOCK_DAYS일, 원본 크기 OPEN_BLOCK_BYTES 이하) 단위로 묶어 저장한다.
+//  - 진행 중 블록: 가격/거래량 열을 [일자][종목] 원본 그대로 보관 (하루 기록 = 두 열 복사)
+//  - 가득 찬 블록: 종목별 가격 열, 거래량 열을 XOR 압축 비트 스트림으로 바꿔 한 버퍼에 연속 저장
+// 보존 일수를 넘은 블록은 통째로 버리므로 실행 일수와 무관하게 메모리 사용량이 제한된다.
+class PriceHistory {
+public:
+    static constexpr size_t BLOCK_DAYS = 128;
+    static constexpr size_t OPEN_BLOCK_BYTES = 32 << 20;
+
+private:
+    // XOR 압축 (Gorilla 방식): 첫 값은 64비트 그대로, 이후는 직전 값과의 XOR를
+    //   0                                    -> 직전 값과 같음
+    //   1 0 + 유효 비트                        -> 직전 유효 비트 구간 안에 들어감
+    //   1 1 + 선행 0 개수(5) + 유효 비트 수-1(6) + 유효 비트
+    // 로 기록한다. 비트는 64비트 워드에 하위 비트부터 채운다.
+    struct XorState {
+        uint64_t prev = 0;
+        unsigned leading = 64;
+        unsigned trailing = 64;
+        bool first = true;
+    };
+
+    class BitWriter {
+    private:
+        vector<uint64_t>& words;
+        uint64_t bitPos;
+
+    public:
+        explicit BitWriter(vector<uint64_t>& w)
+            : words(w), bitPos(w.size() * 64) {}
+
+        uint64_t position() const { return bitPos; }
+
+        void write(uint64_t value, unsigned bits) {
+            if (bits < 64) value &= (uint64_t(1) << bits) - 1;
+
+            unsigned used = static_cast<unsigned>(bitPos % 64);
+            if (used == 0) words.push_back(0);
+
+            words.back() |= value << used;
+            if (used + bits > 64) words.push_back(value >> (64 - used));
+
+            bitPos += bits;
+        }
+
+        void encode(double v, XorState& st) {
+            uint64_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+
+            if (st.first) {
+                write(bits, 64);
+                st.prev = bits;
+                st.first = false;
+                return;
+            }
+
+            uint64_t x = bits ^ st.prev;
+            st.prev = bits;
+
+            if (x == 0) {
+                write(0, 1);
+                return;
+            }
+
+            unsigned leading = min(31u, static_cast<unsigned>(__builtin_clzll(x)));
+            unsigned trailing = static_cast<unsigned>(__builtin_ctzll(x));
+
+            if (leading >= st.leading && trailing >= st.trailing) {
+                write(1, 2);    // 1, 0
+                write(x >> st.trailing, 64 - st.leading - st.trailing);
+            }
+
+            else {
+                unsigned significant = 64 - leading - trailing;
+
+                write(3, 2);    // 1, 1
+                write(leading, 5);
+                write(significant - 1, 6);
+                write(x >> trailing, significant);
+
+                st.leading = leading;
+                st.trailing = trailing;
+            }
+        }
+    };
+
+    class BitReader {
+    private:
+        const uint64_t* words;
+        uint64_t bitPos;
+        XorState st;
+
+        uint64_t read(unsigned bits) {
+            size_t word = bitPos / 64;
+            unsigned used = static_cast<unsigned>(bitPos % 64);
+
+            uint64_t value = words[word] >> used;
+            if (used + bits > 64) value |= words[word + 1] << (64 - used);
+
+            bitPos += bits;
+
+            return bits < 64 ? value & ((uint64_t(1) << bits) - 1) : value;
+        }
+
+    public:
+        BitReader(const uint64_t* w, uint64_t start)
+            : words(w), bitPos(start) {}
+
+        double next() {
+            if (st.first) {
+                st.prev = read(64);
+                st.first = false;
+            }
+
+            else if (read(1) != 0) {
+                if (read(1) != 0) {
+                    st.leading = static_cast<unsigned>(read(5));
+                    st.trailing = 64 - st.leading - static_cast<unsigned>(read(6) + 1);
+                }
+
+                st.prev ^= read(64 - st.leading - st.trailing) << st.trailing;
+            }
+
+            double v;
+            memcpy(&v, &st.prev, sizeof(v));
+
+            return v;
+        }
+    };
+
+    struct SealedBlock {
+        uint64_t firstDay;
+        size_t dayCount;
+        size_t stockCount;
+        vector<uint64_t> offsets;   // 종목 s의 가격 스트림 = offsets[2s], 거래량 스트림 = offsets[2s + 1] (비트 위치)
+        vector<uint64_t> bits;
+    };
+
+    deque<SealedBlock> sealed;
+
+    // 진행 중 블록 ([일자][종목] 원본)
+    uint64_t openFirstDay;
+    size_t openDays;
+    size_t openCapacity;        // 이 블록의 최대 일수 (종목 수가 많으면 줄어듦)
+    size_t openStocks;
+    vector<double> openPrice;
+    vector<double> openVolume;
+
+    uint64_t endDay;            // 다음에 기록할 일자
+    size_t retentionDays;       // 0이면 무제한
+
+    bool hasData() const { return !sealed.empty() || openDays > 0; }
+
+    // 진행 중 블록을 종목별 XOR 스트림으로 압축해 봉인
+    void sealOpenBlock() {
+        if (openDays == 0) return;
+
+        SealedBlock block;
+        block.firstDay = openFirstDay;
+        block.dayCount = openDays;
+        block.stockCount = openStocks;
+        block.offsets.resize(openStocks * 2);
+
+        BitWriter writer(block.bits);
+
+        for (size_t s = 0; s < openStocks; ++s) {
+            XorState priceState;
+            block.offsets[s * 2] = writer.position();
+            for (size_t d = 0; d < openDays; ++d) writer.encode(openPrice[d * openStocks + s], priceState);
+
+            XorState volumeState;
+            block.offsets[s * 2 + 1] = writer.position();
+            for (size_t d = 0; d < openDays; ++d) writer.encode(openVolume[d * openStocks + s], volumeState);
+        }
+
+        block.bits.push_back(0);    // 읽기 시 다음 워드 접근 보호
+        block.bits.shrink_to_fit();
+        sealed.push_back(move(block));
+
+        openFirstDay += openDays;
+        openDays = 0;
+    }
+
+    // 보존 기간 밖으로 완전히 벗어난 블록 제거
+    void enforceRetention() {
+        if (retentionDays == 0) return;
+
+        while (!sealed.empty() && sealed.front().firstDay + sealed.front().dayCount + retentionDays <= endDay) {
+            sealed.pop_front();
+        }
+    }
+
+    // 봉인 블록의 종목 s를 [from, to) (블록 기준 일자) 구간만 디코딩
+    static void decodeRange(const SealedBlock& block, size_t s, size_t from, size_t to, MarketBar* out) {
+        if (s >= block.stockCount) {
+            fill(out, out + (to - from), MarketBar{ 0.0, 0.0 });
+            return;
+        }
+
+        BitReader prices(block.bits.data(), block.offsets[s * 2]);
+        BitReader volumes(block.bits.data(), block.offsets[s * 2 + 1]);
+
+        for (size_t d = 0; d < to; ++d) {
+            double price = prices.next();
+            double vol = volumes.next();
+
+            if (d >= from) out[d - from] = MarketBar{ price, vol };
+        }
+    }
+
+public:
+    explicit PriceHistory(size_t retentionDays = 0)
+        : openFirstDay(0), openDays(0), openCapacity(0), openStocks(0), endDay(0), retentionDays(retentionDays) {}
+
+    void setRetention(size_t days) {
+        retentionDays = days;
+        enforceRetention();
+    }
+
+    void clear() {
+        sealed.clear();
+        openDays = 0;
+        openCapacity = 0;
+        openStocks = 0;
+        openPrice.clear();
+        openVolume.clear();
+        openFirstDay = endDay = 0;
+    }
+
+    // day일 장 마감 시세를 기록. 일자는 연속이어야 하며 끊기면 이력을 새로 시작한다.
+    void record(uint64_t day, const StockTable& table) {
+        if (!hasData() || day != endDay) {
+            clear();
+            openFirstDay = endDay = day;
+        }
+
+        size_t stocks = table.size();
+
+        // 종목 수가 바뀌면 블록을 일찍 봉인 (블록 내 종목 수 고정)
+        if (openDays == openCapacity || (openDays > 0 && stocks != openStocks)) sealOpenBlock();
+
+        if (openDays == 0) {
+            openStocks = stocks;
+            openCapacity = max<size_t>(1, min(BLOCK_DAYS, OPEN_BLOCK_BYTES / max<size_t>(1, stocks * sizeof(MarketBar))));
+            openPrice.resize(openCapacity * stocks);
+            openVolume.resize(openCapacity * stocks);
+        }
+
+        copy(table.priceData(), table.priceData() + stocks, openPrice.begin() + openDays * stocks);
+        copy(table.volumeData(), table.volumeData() + stocks, openVolume.begin() + openDays * stocks);
+
+        ++openDays;
+        ++endDay;
+
+        enforceRetention();
+    }
+
+    bool empty() const { return !hasData(); }
+
+    // 보존 중인 가장 오래된 일자
+    uint64_t getFirstDay() const { return sealed.empty() ? openFirstDay : sealed.front().firstDay; }
+
+    // 마지막 기록 일자 + 1
+    uint64_t getEndDay() const { return endDay; }
+
+    // 종목 id의 [from, to) 일자 시세 (등록 전 일자는 0). 보존 범위 밖이면 false.
+    bool range(SymbolId id, uint64_t from, uint64_t to, vector<MarketBar>& out) const {
+        out.clear();
+        if (!hasData() || id < 0 || from > to || from < getFirstDay() || to > endDay) return false;
+
+        out.resize(static_cast<size_t>(to - from));
+        size_t s = static_cast<size_t>(id);
+
+        // from을 포함하는 첫 봉인 블록 (블록 시작일 기준 이분 탐색)
+        auto it = upper_bound(sealed.begin(), sealed.end(), from,
+                              [](uint64_t day, const SealedBlock& b) { return day < b.firstDay; });
+        if (it != sealed.begin()) --it;
+
+        uint64_t day = from;
+
+        for (; it != sealed.end() && day < to; ++it) {
+            uint64_t blockEnd = it->firstDay + it->dayCount;
+            if (day >= blockEnd) continue;
+
+            uint64_t stop = min(to, blockEnd);
+            decodeRange(*it, s, static_cast<size_t>(day - it->firstDay), static_cast<size_t>(stop - it->firstDay),
+                        out.data() + (day - from));
+            day = stop;
+        }
+
+        for (; day < to; ++day) {
+            size_t d = static_cast<size_t>(day - openFirstDay);
+            out[day - from] = s < openStocks ? MarketBar{ openPrice[d * openStocks + s], openVolume[d * openStocks + s] }
+                                             : MarketBar{ 0.0, 0.0 };
+        }
+
+        return true;
+    }
+
+    // 종목 id의 최근 n일 시세 (오래된 순). 보존된 일수가 적으면 있는 만큼만.
+    bool lastDays(SymbolId id, size_t n, vector<MarketBar>& out) const {
+        uint64_t from = endDay - min<uint64_t>(n, endDay - getFirstDay());
+        return range(id, from, endDay, out);
+    }
+
+    // day일 전 종목 시세 (종목 ID 순서)
+    bool dayBars(uint64_t day, size_t stockCount, vector<MarketBar>& out) const {
+        out.clear();
+        if (!hasData() || day < getFirstDay() || day >= endDay) return false;
+
+        out.resize(stockCount, MarketBar{ 0.0, 0.0 });
+
+        if (day >= openFirstDay) {
+            size_t d = static_cast<size_t>(day - openFirstDay);
+            size_t n = min(stockCount, openStocks);
+
+            for (size_t s = 0; s < n; ++s) {
+                out[s] = MarketBar{ openPrice[d * openStocks + s], openVolume[d * openStocks + s] };
+            }
+
+            return true;
+        }
+
+        auto it = upper_bound(sealed.begin(), sealed.end(), day,
+                              [](uint64_t value, const SealedBlock& b) { return value < b.firstDay; });
+        const SealedBlock& block = *(it - 1);
+        size_t d = static_cast<size_t>(day - block.firstDay);
+        size_t n = min(stockCount, block.stockCount);
+
+        for (size_t s = 0; s < n; ++s) {
+            decodeRange(block, s, d, d + 1, &out[s]);
+        }
+
+        return true;
+    }
+
+    // 이력 저장에 쓰는 메모리 (바이트)
+    size_t memoryBytes() const {
+        size_t bytes = (openPrice.capacity() + openVolume.capacity()) * sizeof(double);
+
+        for (const SealedBlock& block : sealed) {
+            bytes += block.bits.capacity() * sizeof(uint64_t) + block.offsets.capacity() * sizeof(uint64_t);
+        }
+
+        return bytes;
+    }
+
+    // 같은 일수를 압축 없이 저장할 때의 크기 (바이트)
+    size_t rawBytes() const {
+        size_t bytes = openDays * openStocks * sizeof(MarketBar);
+        for (const SealedBlock& block : sealed) bytes += block.dayCount * block.stockCount * sizeof(MarketBar);
+
+        return bytes;
+    }
+};
+
+// ============================================================
+// 팀원 A: RollingIndicators (종목별 이동 구간 지표)
+// ============================================================
+// 최근 window일의 종가/변동률/거래량/가격 범위를 링 버퍼에 두고, 종목별 지표를 하루 O(1)로 갱신한다.
+//  - 모든 종목이 같은 날 갱신되므로 링 위치(pos)는 시장 공통이고, 링은 [칸][종목] 순서로 둔다
+//    -> 하루 갱신은 칸 하나를 종목 방향으로 훑는 루프 (구간 단위 병렬, 자동 벡터화)
+//  - 이동 합계는 빠지는 칸을 빼고 새 값을 더하는 증분 갱신. 링이 한 바퀴 돌 때마다 정확히 다시 합산해 오차 누적을 막는다
+//  - 구간 최고가는 블록 방식: 한 바퀴가 끝날 때 그 블록의 접미 최대값을 만들어 두고
+//    구간 최고 = max(이번 블록 접두 최대, 직전 블록 접미 최대[pos + 1]) (두 작업 모두 분할 상환 O(1))
+//  - 결과 열(이동 평균, 변동성, 고점 대비 낙폭, 평균 가격 범위, 거래량 z)도 종목 방향 연속 배열이라 선별 커널이 그대로 훑는다
+// 일별 시세에는 종가만 있으므로 가격 범위(ATR)는 고가/저가 대신 전일 종가 대비 |종가 변화|로 계산한다.
+// 지표를 켠 뒤 추가된 종목은 이미 채워진 칸을 추가 시점의 가격/거래량으로 채운다 (그동안 변동이 없던 것으로 간주).
+class RollingIndicators {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+public:
+    static constexpr size_t DEFAULT_WINDOW = 20;
+
+private:
+    size_t window;
+    size_t pos;         // 다음에 쓸 칸
+    size_t filled;      // 채워진 칸 수 (<= window)
+    size_t count;       // 종목 수
+    size_t stride;      // 칸 하나의 종목 용량
+
+    // 링: [칸 * stride + 종목]
+    vector<double> closeRing;
+    vector<double> rateRing;
+    vector<double> volumeRing;
+    vector<double> rangeRing;
+    vector<double> suffixMax;       // 마지막으로 끝난 블록의 접미 최대 종가 (같은 배치)
+
+    // 종목별 이동 합계, 이번 블록 접두 최대
+    vector<double> closeSum;
+    vector<double> rateSum;
+    vector<double> rateSquareSum;
+    vector<double> volumeSum;
+    vector<double> volumeSquareSum;
+    vector<double> rangeSum;
+    vector<double> prefixMax;
+
+    // 결과 열
+    vector<double> movingAverage;
+    vector<double> volatility;
+    vector<double> drawdown;
+    vector<double> averageRange;
+    vector<double> volumeZ;
+
+    // 링 용량을 newStride 종목으로 늘림 (칸마다 기존 행 복사)
+    void regrow(size_t newStride) {
+        for (vector<double>* ring : { &closeRing, &rateRing, &volumeRing, &rangeRing, &suffixMax }) {
+            vector<double> grown(window * newStride, 0.0);
+
+            for (size_t s = 0; s < window; ++s) {
+                copy(ring->begin() + s * stride, ring->begin() + s * stride + count, grown.begin() + s * newStride);
+            }
+
+            ring->swap(grown);
+        }
+
+        stride = newStride;
+    }
+
+    // 한 바퀴가 끝난 블록: [begin, end) 종목의 이동 합계를 정확히 다시 합산하고 접미 최대를 만듦
+    void rebuildBlock(size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            closeSum[i] = rateSum[i] = rateSquareSum[i] = 0.0;
+            volumeSum[i] = volumeSquareSum[i] = rangeSum[i] = 0.0;
+        }
+
+        for (size_t s = 0; s < window; ++s) {
+            const size_t row = s * stride;
+
+            for (size_t i = begin; i < end; ++i) {
+                double rate = rateRing[row + i];
+                double v = volumeRing[row + i];
+
+                closeSum[i] += closeRing[row + i];
+                rateSum[i] += rate;
+                rateSquareSum[i] += rate * rate;
+                volumeSum[i] += v;
+                volumeSquareSum[i] += v * v;
+                rangeSum[i] += rangeRing[row + i];
+            }
+        }
+
+        const size_t last = (window - 1) * stride;
+        copy(closeRing.begin() + last + begin, closeRing.begin() + last + end, suffixMax.begin() + last + begin);
+
+        for (size_t s = window - 1; s-- > 0;) {
+            const size_t row = s * stride;
+            const size_t next = row + stride;
+
+            for (size_t i = begin; i < end; ++i) suffixMax[row + i] = max(closeRing[row + i], suffixMax[next + i]);
+        }
+    }
+
+public:
+    explicit RollingIndicators(size_t window = DEFAULT_WINDOW)
+        : window(max<size_t>(window, 1)), pos(0), filled(0), count(0), stride(0) {}
+
+    size_t getWindow() const { return window; }
+
+    // 지금까지 기록한 일수 (window에서 멈춤)
+    size_t getFilled() const { return filled; }
+
+    size_t size() const { return count; }
+
+    // 표에 새로 생긴 종목의 자리를 만들고 채워진 칸을 현재 가격/거래량으로 채움 (갱신 사이에 단일 스레드로 호출)
+    void ensureStocks(const StockTable& table) {
+        const size_t n = table.size();
+        if (n <= count) return;
+
+        if (n > stride) regrow(max({ stride * 2, n, size_t(64) }));
+
+        for (vector<double>* column : { &closeSum, &rateSum, &rateSquareSum, &volumeSum, &volumeSquareSum, &rangeSum,
+                                        &prefixMax, &movingAverage, &volatility, &drawdown, &averageRange, &volumeZ }) {
+            column->resize(n, 0.0);
+        }
+
+        for (size_t i = count; i < n; ++i) {
+            double price = table.getCurrentPrice(i);
+            double v = table.getVolume(i);
+
+            // 채워진 칸이 없던 블록의 접미 최대는 0 (종가는 항상 양수)
+            for (size_t s = 0; s < window; ++s) {
+                closeRing[s * stride + i] = s < filled ? price : 0.0;
+                volumeRing[s * stride + i] = s < filled ? v : 0.0;
+                suffixMax[s * stride + i] = filled == window ? price : 0.0;
+            }
+
+            closeSum[i] = filled * price;
+            volumeSum[i] = filled * v;
+            volumeSquareSum[i] = filled * v * v;
+            prefixMax[i] = price;
+            movingAverage[i] = price;
+        }
+
+        count = n;
+    }
+
+    // 오늘 종가 반영: [begin, end) 종목 (표의 현재가 = 오늘 종가, 전일가 = 전일 종가). 구간끼리는 병렬 호출 가능
+    void update(size_t begin, size_t end, const StockTable& table) {
+        const double* cur = table.priceData();
+        const double* prev = table.previousPriceData();
+        const double* vol = table.volumeData();
+
+        const size_t row = pos * stride;
+        const double inv = 1.0 / static_cast<double>(min(filled + 1, window));     // 갱신 후 칸 수의 역수
+        const double prevInv = filled > 0 ? 1.0 / static_cast<double>(filled) : 0.0;
+        const bool zReady = filled >= 2;
+        const bool blockStart = pos == 0;
+        // 직전 블록에서 아직 구간에 남은 칸의 최고가 (마지막 칸을 쓰는 날은 구간 = 이번 블록)
+        const double* tailMax = pos + 1 < window ? suffixMax.data() + row + stride : nullptr;
+
+        for (size_t i = begin; i < end; ++i) {
+            double c = cur[i];
+            double rate = StockTable::fluctuationRate(c, prev[i]);
+            double range = fabs(c - prev[i]);
+            double v = vol[i];
+
+            // 거래량 z: 오늘을 넣기 전 구간의 평균/표준편차 기준
+            double meanVolume = volumeSum[i] * prevInv;
+            double varVolume = volumeSquareSum[i] * prevInv - meanVolume * meanVolume;
+            bool spread = zReady & (varVolume > 1e-12 * meanVolume * meanVolume);
+            volumeZ[i] = spread ? (v - meanVolume) / sqrt(varVolume) : 0.0;
+
+            double oldRate = rateRing[row + i];
+            double oldVolume = volumeRing[row + i];
+
+            closeSum[i] += c - closeRing[row + i];
+            rateSum[i] += rate - oldRate;
+            rateSquareSum[i] += rate * rate - oldRate * oldRate;
+            volumeSum[i] += v - oldVolume;
+            volumeSquareSum[i] += v * v - oldVolume * oldVolume;
+            rangeSum[i] += range - rangeRing[row + i];
+
+            closeRing[row + i] = c;
+            rateRing[row + i] = rate;
+            volumeRing[row + i] = v;
+            rangeRing[row + i] = range;
+
+            double peak = blockStart ? c : max(prefixMax[i], c);
+            prefixMax[i] = peak;
+            if (tailMax) peak = max(peak, tailMax[i]);
+
+            double meanRate = rateSum[i] * inv;
+
+            movingAverage[i] = closeSum[i] * inv;
+            volatility[i] = sqrt(max(0.0, rateSquareSum[i] * inv - meanRate * meanRate));
+            drawdown[i] = c / peak - 1.0;
+            averageRange[i] = rangeSum[i] * inv;
+        }
+
+        if (pos + 1 == window) rebuildBlock(begin, end);
+    }
+
+    // 모든 구간의 update가 끝난 뒤 다음 칸으로
+    void advance() {
+        pos = pos + 1 == window ? 0 : pos + 1;
+        filled = min(filled + 1, window);
+    }
+
+    // ---------- 종목별 조회 (i = SymbolId) ----------
+
+    // 최근 window일 종가 평균
+    double getMovingAverage(size_t i) const { return movingAverage[i]; }
+
+    // 최근 window일 일별 변동률의 표준편차
+    double getVolatility(size_t i) const { return volatility[i]; }
+
+    // 구간 최고 종가 대비 현재 종가 (-0.2 = 고점 대비 20% 하락)
+    double getDrawdown(size_t i) const { return drawdown[i]; }
+
+    // 평균 가격 범위 (가격 단위, ATR)
+    double getAverageRange(size_t i) const { return averageRange[i]; }
+
+    // 오늘 거래량의 z 점수 (직전 구간 평균/표준편차 기준, 구간이 2일 미만이거나 변동이 없으면 0)
+    double getVolumeZ(size_t i) const { return volumeZ[i]; }
+
+    // 열 단위 읽기 (종목 순서 연속)
+    const double* drawdownData() const { return drawdown.data(); }
+
+    const double* volumeZData() const { return volumeZ.data(); }
+
+    // 고점 대비 낙폭 < maxDrawdown 이고 거래량 z > minVolumeZ 인 종목 중 상위 k개를 out에 순위대로 기록, 개수 반환.
+    // 후보의 fall = 낙폭, volumeRatio = 거래량 z (낙폭 큰 순 -> z 큰 순 -> 종목 순서). StockTable::selectFallers와 같은 방식
+    size_t selectDrawdowns(double maxDrawdown, double minVolumeZ, size_t k, StockTable::Candidate* out) const {
+        static constexpr size_t FILTER_BLOCK = 256;
+
+        if (k == 0) return 0;
+
+        const double* dd = drawdown.data();
+        const double* z = volumeZ.data();
+
+        size_t hits[FILTER_BLOCK];
+        size_t found = 0;
+
+        for (size_t base = 0; base < count; base += FILTER_BLOCK) {
+            size_t end = min(count, base + FILTER_BLOCK);
+            size_t passed = 0;
+
+            for (size_t i = base; i < end; ++i) {
+                hits[passed] = i;
+                passed += static_cast<size_t>((dd[i] < maxDrawdown) & (z[i] > minVolumeZ));
+            }
+
+            for (size_t h = 0; h < passed; ++h) {
+                size_t i = hits[h];
+                found = StockTable::Candidate::offer(out, found, k, StockTable::Candidate{ dd[i], z[i], i });
+            }
+        }
+
+        sort_heap(out, out + found, StockTable::Candidate::better);
+
+        return found;
+    }
+
+    size_t memoryBytes() const {
+        return (5 * window * stride + 12 * count) * sizeof(double);
+    }
+};
+
+// ============================================================
+// 팀원 A: FactorModel (상관된 다요인 수익률 모형)
+// ============================================================
+// 종목 수익률 = 요인 노출 x 요인 수익률 + 고유 변동 (+ 시장 전체 급락).
+//  - 요인: 시장 1개 + 섹터 sectors개. 요인 공분산 Σ(섹터끼리 상관 sectorCorrelation)를 Cholesky 분해(Σ = L Lᵀ)해 두고,
+//    매일 표준정규 z로 요인 수익률 f = L z를 만든다 (요인 수 K가 작으므로 하루 한 번, 단일 스레드).
+//  - 종목별 노출 B(n x K)는 요인별 열 배열(SoA)로 두고, 구간 [begin, end)의 요인 부분 r = B f를
+//    요인마다 종목 방향으로 한 번씩 훑는 열 단위 GEMV로 계산한다 (종목 방향으로 자동 벡터화).
+//  - 급락: 종목마다가 아니라 하루 단위로 jumpProbability 확률로 일어나며, 모든 종목이 시장 베타만큼 함께 떨어지고 거래량이 급증한다.
+// 난수는 (시드, 일자, 종목) 키의 Philox라 구간 분할/스레드 수와 무관하게 같은 결과이며,
+// 노출은 structureSeed로만 정해지므로 경로 시드가 달라도 시장 구조는 같다.
+class FactorModel {
+public:
+    static constexpr size_t MAX_SECTORS = 32;
+    static constexpr size_t MAX_FACTORS = MAX_SECTORS + 1;
+
+    struct Config {
+        size_t sectors = 10;
+        double marketVolatility = 0.012;        // 시장 요인 일별 표준편차
+        double sectorVolatility = 0.008;        // 섹터 요인 일별 표준편차
+        double sectorCorrelation = 0.3;         // 섹터 요인끼리 상관계수 (0 ~ 0.99)
+        double crossLoading = 0.1;              // 소속 외 섹터 노출 범위 (±)
+        double idiosyncraticVolatility = 0.01;  // 고유 변동 표준편차 (종목별 0.5 ~ 1.5배)
+        double jumpProbability = 0.03;          // 하루에 시장 전체 급락이 일어날 확률
+        double jumpMean = -0.18;                // 급락 크기 평균 (시장 베타 1 기준)
+        double jumpVolatility = 0.05;
+        uint64_t structureSeed = 0;             // 종목별 노출 생성 시드
+    };
+
+    // 하루치 공통 요인 (drawDay 결과, generate 입력)
+    struct Day {
+        array<double, MAX_FACTORS> factorReturn;
+        bool jump;
+        double jumpReturn;
+        double jumpTime;            // 장중 급락 시각 (0 ~ 1)
+    };
+
+private:
+    static constexpr uint64_t FACTOR_STREAM = 0xFAC7;
+    static constexpr uint64_t STRUCTURE_STREAM = 0x5EC7;
+    static constexpr uint64_t JUMP_INDEX = 1ull << 40;
+
+    Config cfg;
+    size_t factorCount;
+    array<double, MAX_FACTORS * MAX_FACTORS> cholesky;     // 하삼각 L (행 우선)
+
+    // 노출 B: loadings[k][i] = 종목 i의 요인 k 노출 (k = 0 시장, 1.. 섹터)
+    array<vector<double>, MAX_FACTORS> loadings;
+    vector<double> idiosyncratic;   // 종목별 고유 변동 표준편차
+
+    // Box-Muller (u1, u2 -> 표준정규 하나)
+    static double normal(uint32_t a, uint32_t b) {
+        double u1 = 1.0 - Philox4x32::toUnit(a);   // (0, 1]
+        double u2 = Philox4x32::toUnit(b);
+
+        return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+    }
+
+    // Σ = L Lᵀ (Σ는 양의 정부호로 구성되므로 대각은 항상 양수)
+    void decompose() {
+        array<double, MAX_FACTORS * MAX_FACTORS> sigma{};
+        const size_t K = factorCount;
+        double sectorVar = cfg.sectorVolatility * cfg.sectorVolatility;
+
+        sigma[0] = cfg.marketVolatility * cfg.marketVolatility;
+
+        for (size_t a = 1; a < K; ++a) {
+            for (size_t b = 1; b < K; ++b) sigma[a * K + b] = a == b ? sectorVar : cfg.sectorCorrelation * sectorVar;
+        }
+
+        cholesky.fill(0.0);
+
+        for (size_t a = 0; a < K; ++a) {
+            for (size_t b = 0; b <= a; ++b) {
+                double sum = sigma[a * K + b];
+                for (size_t c = 0; c < b; ++c) sum -= cholesky[a * K + c] * cholesky[b * K + c];
+
+                cholesky[a * K + b] = a == b ? sqrt(max(sum, 0.0)) : (cholesky[b * K + b] > 0.0 ? sum / cholesky[b * K + b] : 0.0);
+            }
+        }
+    }
+
+public:
+    explicit FactorModel(const Config& config)
+        : cfg(config) {
+        cfg.sectors = min(max<size_t>(cfg.sectors, 1), MAX_SECTORS);
+        cfg.sectorCorrelation = min(max(cfg.sectorCorrelation, 0.0), 0.99);
+        factorCount = cfg.sectors + 1;
+
+        decompose();
+    }
+
+    const Config& getConfig() const { return cfg; }
+
+    size_t getFactorCount() const { return factorCount; }
+
+    size_t size() const { return idiosyncratic.size(); }
+
+    // 종목 n개까지 노출 생성 (새로 추가된 종목만, 종목 순서로 결정적)
+    void ensureStocks(size_t n) {
+        size_t first = idiosyncratic.size();
+        if (n <= first) return;
+
+        for (size_t k = 0; k < factorCount; ++k) loadings[k].resize(n, 0.0);
+        idiosyncratic.resize(n);
+
+        for (size_t i = first; i < n; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(cfg.structureSeed, STRUCTURE_STREAM, i);
+            size_t sector = 1 + r[0] % cfg.sectors;
+
+            loadings[0][i] = 0.6 + Philox4x32::toUnit(r[1]) * 0.8;                 // 시장 베타 0.6 ~ 1.4
+            idiosyncratic[i] = cfg.idiosyncraticVolatility * (0.5 + Philox4x32::toUnit(r[3]));
+
+            for (size_t k = 1; k < factorCount; ++k) {
+                Philox4x32::Counter c = Philox4x32::generate(cfg.structureSeed, STRUCTURE_STREAM + k, i);
+                loadings[k][i] = (Philox4x32::toUnit(c[0]) * 2.0 - 1.0) * cfg.crossLoading;
+            }
+
+            loadings[sector][i] = 0.5 + Philox4x32::toUnit(r[2]);                  // 소속 섹터 0.5 ~ 1.5
+        }
+    }
+
+    // day일의 공통 요인 수익률 f = L z와 급락 여부
+    Day drawDay(uint64_t seed, uint64_t day) const {
+        uint64_t stream = mixSeed(seed, FACTOR_STREAM);
+        array<double, MAX_FACTORS> z{};
+
+        for (size_t k = 0; k < factorCount; ++k) {
+            Philox4x32::Counter r = Philox4x32::generate(stream, day, k);
+            z[k] = normal(r[0], r[1]);
+        }
+
+        Day d;
+        d.factorReturn.fill(0.0);
+
+        for (size_t a = 0; a < factorCount; ++a) {
+            for (size_t b = 0; b <= a; ++b) d.factorReturn[a] += cholesky[a * factorCount + b] * z[b];
+        }
+
+        Philox4x32::Counter j = Philox4x32::generate(stream, day, JUMP_INDEX);
+        d.jump = Philox4x32::toUnit(j[0]) < cfg.jumpProbability;
+        d.jumpReturn = d.jump ? cfg.jumpMean + cfg.jumpVolatility * normal(j[1], j[2]) : 0.0;
+        d.jumpTime = 0.1 + Philox4x32::toUnit(j[3]) * 0.8;
+
+        return d;
+    }
+
+    // [begin, end) 종목의 하루 변동률과 거래량 배수. ensureStocks(end) 이후에 호출 (구간끼리 동시에 호출해도 안전)
+    void generate(const Day& d, size_t begin, size_t end, uint64_t seed, uint64_t day,
+                  double* changeRate, double* volumeMultiplier) const {
+        // 요인 부분 r = B f: 요인마다 종목 방향으로 한 번씩 (열 단위 GEMV)
+        const double* market = loadings[0].data();
+        double f0 = d.factorReturn[0];
+
+        for (size_t i = begin; i < end; ++i) changeRate[i] = market[i] * f0;
+
+        for (size_t k = 1; k < factorCount; ++k) {
+            const double* b = loadings[k].data();
+            double f = d.factorReturn[k];
+
+            for (size_t i = begin; i < end; ++i) changeRate[i] += b[i] * f;
+        }
+
+        // 고유 변동 + 급락 (시장 베타만큼) + 거래량 (급락일은 2 ~ 4배)
+        double jumpReturn = d.jump ? d.jumpReturn : 0.0;
+        double volumeBase = d.jump ? 2.0 : 0.8;
+        double volumeRange = d.jump ? 2.0 : 0.4;
+
+        for (size_t i = begin; i < end; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(seed, day, i);
+            double rate = changeRate[i] + idiosyncratic[i] * normal(r[0], r[1]) + market[i] * jumpReturn;
+
+            changeRate[i] = max(rate, -0.95);
+            volumeMultiplier[i] = volumeBase + Philox4x32::toUnit(r[2]) * volumeRange;
+        }
+    }
+};
+
+// ============================================================
+// 팀원 A: Market 클래스
+// ============================================================
+class Market {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+public:
+    static constexpr uint64_t NO_TICKET = ~uint64_t(0);
+
+    struct Execution {
+        int quantity;           // 체결 수량 (0이면 미체결)
+        double avgPrice;        // 평균 체결가
+        double notional;        // 체결 금액 합계
+        uint64_t ticket = NO_TICKET;    // 동시 매매 중 주문장 주문이면 잠정 체결: deferredFill(ticket)로 실제 체결 조회
+    };
+
+private:
+    Arena* arena;           // 약한 참조: 시장 데이터를 둘 Arena (nullptr이면 힙)
+    Arena stockArena;       // arena가 없을 때 종목 뷰를 두는 자체 Arena
+    StockTable stockTable;
+    ArenaVector<Stock*> allStocks;
+    TransactionJournal transactionHistory;
+    PriceHistory priceHistory;
+    bool recordHistory;
+
+    // 종목별 이동 구간 지표 (nullptr이면 사용 안 함). 일자 마감 때 구간별로 갱신
+    unique_ptr<RollingIndicators> indicators;
+
+    // 주문장: enableOrderBooks() 후 매매가 닿은 종목만 그날 처음 접근할 때 만들거나 다시 채움
+    bool orderBooksEnabled;
+    vector<unique_ptr<OrderBook>> orderBooks;
+    vector<uint64_t> orderBookDay;
+    vector<double> orderBookPrice;      // 시장조성 호가를 채울 때의 현재가
+
+    // 동시 매매: beginConcurrentTrading() ~ endConcurrentTrading() 사이에는 여러 스레드의 Trader(에이전트)가 동시에 주문한다.
+    // 거래 내역과 주문장 주문은 스레드별 버퍼에 에이전트 번호를 붙여 쌓고 (전역 잠금 없음),
+    // 주문장 체결과 저널 병합은 에이전트 번호 순으로 하므로 결과가 스레드 수·작업 배치와 무관하다.
+    static constexpr size_t ORDER_SHARDS = 64;
+
+    struct PendingTransaction {
+        uint32_t agent;
+        Transaction transaction;
+    };
+
+    // 동시 매매 중 주문장 주문: 현재가로 잠정 체결해 돌려주고 matchDeferredOrders()에서 실제 체결
+    struct DeferredOrder {
+        uint32_t agent;
+        SymbolId id;
+        OrderSide side;
+        int quantity;
+        double maxNotional;
+        Execution actual;
+    };
+
+    bool concurrentTrading;
+    vector<uint32_t> concurrentAgent;                       // [ThreadPool::currentThreadIndex()] 매매 중인 에이전트
+    vector<vector<PendingTransaction>> pendingTransactions; // [ThreadPool::currentThreadIndex()]
+    vector<vector<DeferredOrder>> deferredOrders;           // [ThreadPool::currentThreadIndex()]
+    vector<uint64_t> matchOrder;                            // 체결 순서 (티켓, 에이전트 번호 순)
+    vector<PendingTransaction> pendingMerge;                // 저널 병합 작업 버퍼
+
+    // simulateFluctuation 작업 버퍼 (종목별 난수 결과, 구간별 집계)
+    ArenaVector<double> changeRates;
+    ArenaVector<double> volumeMultipliers;
+    ArenaVector<StockTable::Moments> chunkMoments;
+
+    // 상관 요인 모형 (nullptr이면 종목별 독립 변동 + 종목별 블랙스완)
+    unique_ptr<FactorModel> factorModel;
+
+    // 난수 키: (seed, day, 종목 인덱스)
+    uint64_t seed;
+    uint64_t day;
+    ThreadPool* pool;   // 약한 참조 (nullptr이면 단일 스레드)
+
+    // 가상 시계: 일자가 넘어가면 그날 장 마감(15:30), 장중에는 틱 시각으로 진행. 거래 기록 시각의 기준
+    SimClock ownClock;
+    SimClock* clock;    // 약한 참조: setClock()으로 주입한 시계 (기본은 ownClock)
+
+    // 병렬 분할 단위 (스레드 수와 무관하게 고정)
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    // 시장조성 유동성: 현재가 위아래로 MAKER_LEVELS개 호가, 호가 단위 = 가격의 0.1%, 호가당 잔량 = 평균 거래량의 0.005%
+    static constexpr double TICK_RATIO = 0.001;
+    static constexpr int32_t MAKER_LEVELS = 20;
+    static constexpr double MAKER_DEPTH_RATIO = 0.00005;
+    static constexpr uint32_t MARKET_MAKER = 0;
+
+    // 티켓 = (스레드 번호 << 32) | 스레드 버퍼 안의 위치
+    DeferredOrder& deferredOrder(uint64_t ticket) { return deferredOrders[ticket >> 32][ticket & 0xffffffffu]; }
+    const DeferredOrder& deferredOrder(uint64_t ticket) const { return deferredOrders[ticket >> 32][ticket & 0xffffffffu]; }
+
+    // 체결 결과 작업 버퍼 (동시 매매 중에도 스레드끼리 공유하지 않도록 스레드별)
+    static vector<OrderBook::Fill>& fillBuffer() {
+        static thread_local vector<OrderBook::Fill> fills;
+        return fills;
+    }
+
+    void seedOrderBook(OrderBook& book, size_t i) {
+        double price = stockTable.getCurrentPrice(i);
+        int32_t depth = max<int32_t>(1, static_cast<int32_t>(stockTable.getAverageVolume(i) * MAKER_DEPTH_RATIO));
+        vector<OrderBook::Fill>& fills = fillBuffer();
+
+        book.reset(price, price * TICK_RATIO);
+        fills.clear();
+
+        for (int32_t k = 1; k <= MAKER_LEVELS; ++k) {
+            book.addLimit(OrderSide::Sell, price + k * book.getTickSize(), depth, MARKET_MAKER, fills);
+            book.addLimit(OrderSide::Buy, price - k * book.getTickSize(), depth, MARKET_MAKER, fills);
+        }
+    }
+
+    // [begin, end) 구간 종목의 일일 변동 계산 및 적용, 구간 집계 반환
+    StockTable::Moments simulateRange(size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(seed, day, i);
+            double randomValue = Philox4x32::toUnit(r[0]);  // 0.0 ~ 1.0
+            double changeRate;
+            double volumeMultiplier;
+
+            // 시장 변동 시뮬레이션
+            if (randomValue < 0.95) {
+                // 95% 확률로 정상
+                changeRate = Philox4x32::toUnit(r[1]) * 0.04 - 0.02;  // -2% ~ +2%
+                volumeMultiplier = 0.8 + Philox4x32::toUnit(r[2]) * 0.4;
+            }
+
+            else {
+                // 5% 확률로 블랙스완
+                changeRate = Philox4x32::toUnit(r[1]) * (-0.20) - 0.10;  // -10% ~ -30%
+                volumeMultiplier = 2.0 + Philox4x32::toUnit(r[2]) * 2.0;
+            }
+
+            changeRates[i] = changeRate;
+            volumeMultipliers[i] = volumeMultiplier;
+        }
+
+        // 가격/거래량 일괄 갱신 (SoA 커널)
+        return stockTable.applyFluctuation(begin, end, changeRates.data(), volumeMultipliers.data());
+    }
+
+    // 종목을 CHUNK_SIZE 구간으로 나눠 rangeFn(begin, end)를 (가능하면 병렬로) 실행하고,
+    // 구간 집계를 고정된 순서로 병합 -> 스레드 수와 무관하게 동일한 결과
+    template <typename RangeFn>
+    void runChunked(RangeFn rangeFn) {
+        const size_t n = stockTable.size();
+        size_t chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        chunkMoments.resize(chunks);
+
+        if (indicators) indicators->ensureStocks(stockTable);
+
+        auto runChunk = [&](size_t c) {
+            size_t begin = c * CHUNK_SIZE;
+            size_t end = min(n, begin + CHUNK_SIZE);
+
+            chunkMoments[c] = rangeFn(begin, end);
+
+            // 방금 갱신한 구간이 캐시에 있을 때 이어서 지표 갱신
+            if (indicators) indicators->update(begin, end, stockTable);
+        };
+
+        if (pool && chunks > 1) {
+            pool->parallelFor(chunks, runChunk);
+        }
+
+        else {
+            for (size_t c = 0; c < chunks; ++c) runChunk(c);
+        }
+
+        stockTable.commitBulkUpdate(chunkMoments.data(), chunks);
+        if (indicators) indicators->advance();
+
+        ++day;
+        clock->advanceTo(SimClock::at(day, SimClock::SESSION_CLOSE));
+
+        if (recordHistory) priceHistory.record(day, stockTable);
+    }
+
+public:
+    // arena를 넘기면 종목 뷰, 가격/거래량 배열, 작업 버퍼, 메모리 거래 저널을 그 안에 둔다
+    // (몬테카를로처럼 시장을 반복 생성할 때 경로마다 Arena::reset()으로 한 번에 회수)
+    explicit Market(uint64_t seed = 0, Arena* arena = nullptr)
+        : arena(arena), stockArena(4096), stockTable(arena), allStocks(ArenaAllocator<Stock*>(arena)),
+          transactionHistory(arena), recordHistory(false), orderBooksEnabled(false), concurrentTrading(false),
+          changeRates(ArenaAllocator<double>(arena)), volumeMultipliers(ArenaAllocator<double>(arena)),
+          chunkMoments(ArenaAllocator<StockTable::Moments>(arena)), seed(seed), day(0), pool(nullptr), clock(&ownClock) {}
+
+    // 종목 뷰는 Arena에 있으므로 개별 delete 없음 (자체 Arena는 소멸하며 청크째 해제)
+    ~Market() = default;
+
+    Market(const Market&) = delete;
+    Market& operator=(const Market&) = delete;
+
+    Stock* addStock(const string& name, double initPrice, double initVolume) {
+        size_t index = stockTable.add(name, initPrice, initVolume);
+
+        // 이미 등록된 종목명이면 기존 종목 반환
+        if (index < allStocks.size()) return allStocks[index];
+
+        static_assert(is_trivially_destructible<Stock>::value, "Arena의 종목 뷰는 소멸자를 부르지 않음");
+
+        Stock* stock = (arena ? arena : &stockArena)->create<Stock>(&stockTable, index);
+        allStocks.push_back(stock);
+
+        if (indicators) indicators->ensureStocks(stockTable);
+
+        return stock;
+    }
+
+    void setSeed(uint64_t s) { seed = s; }
+
+    uint64_t getSeed() const { return seed; }
+
+    uint64_t getDay() const { return day; }
+
+    void setThreadPool(ThreadPool* p) { pool = p; }
+
+    // 외부 시계 주입 (여러 시장이 하나의 시계를 공유할 때). nullptr이면 자체 시계로 복귀
+    void setClock(SimClock* c) { clock = c ? c : &ownClock; }
+
+    const SimClock& getClock() const { return *clock; }
+
+    // 현재 가상 시각 (거래 기록용)
+    SimTime now() const { return clock->now(); }
+
+    // 장중 진행: 시계를 t까지 앞으로 (뒤로는 가지 않음)
+    void advanceClock(SimTime t) { clock->advanceTo(t); }
+
+    void simulateFluctuation() {
+        PROFILE_SCOPE(Probe::SimulateFluctuation);
+
+        const size_t n = stockTable.size();
+        changeRates.resize(n);
+        volumeMultipliers.resize(n);
+
+        if (factorModel) {
+            // 공통 요인은 하루 한 번, 종목 부분은 구간별로 (요인 GEMV + 고유 변동)
+            factorModel->ensureStocks(n);
+            FactorModel::Day factorDay = factorModel->drawDay(seed, day);
+
+            runChunked([&](size_t begin, size_t end) {
+                factorModel->generate(factorDay, begin, end, seed, day, changeRates.data(), volumeMultipliers.data());
+                return stockTable.applyFluctuation(begin, end, changeRates.data(), volumeMultipliers.data());
+            });
+
+            return;
+        }
+
+        runChunked([&](size_t begin, size_t end) { return simulateRange(begin, end); });
+    }
+
+    // 일일 변동을 상관 요인 모형으로 생성 (종목 추가 전후 어느 때나 호출 가능)
+    void enableFactorModel(const FactorModel::Config& cfg) { factorModel = make_unique<FactorModel>(cfg); }
+
+    // 요인 모형 (사용하지 않으면 nullptr). 장중 시뮬레이션이 같은 일별 종가를 만들 때 사용
+    const FactorModel* getFactorModel() const { return factorModel.get(); }
+
+    // ---------- 장중 시뮬레이션 (IntradaySimulator) ----------
+
+    // 장 시작: 전일가 = 전일 종가
+    void beginIntradayDay() {
+        stockTable.rollPreviousClose();
+
+        if (factorModel) factorModel->ensureStocks(stockTable.size());
+    }
+
+    // 장중 체결가 반영. 전일가는 전일 종가로 유지되므로 변동률은 당일 누적 등락률.
+    void setIntradayPrice(SymbolId id, double price) { stockTable.setIntradayPrice(static_cast<size_t>(id), price); }
+
+    void setIntradayVolume(SymbolId id, double dayVolume, double baseAverage) {
+        stockTable.setIntradayVolume(static_cast<size_t>(id), dayVolume, baseAverage);
+    }
+
+    // 장 마감: 집계를 일괄 경로와 같은 순서로 다시 계산하고 다음 날로 넘어감
+    void endIntradayDay() {
+        runChunked([&](size_t begin, size_t end) { return stockTable.rangeMoments(begin, end); });
+    }
+
+    // 무작위 변동 대신 과거 시세 하루치를 적용. bars는 종목 ID 순서로 size()개.
+    void replayDay(const MarketBar* bars) {
+        runChunked([&](size_t begin, size_t end) { return stockTable.applyBars(begin, end, bars); });
+    }
+
+    // 외부 입력(종목명) -> ID 변환. 매매 경로에서는 ID를 사용한다.
+    SymbolId findSymbol(const string& name) const {
+        return stockTable.getSymbols().find(name);
+    }
+
+    Stock* getStockById(SymbolId id) const {
+        if (id < 0 || static_cast<size_t>(id) >= allStocks.size()) return nullptr;
+
+        return allStocks[id];
+    }
+
+    Stock* getStockByName(const string& name) const {
+        return getStockById(findSymbol(name));
+    }
+
+    const SymbolTable& getSymbols() const { return stockTable.getSymbols(); }
+
+    // 아래 집계는 가격 갱신 시 누적 관리되므로 모두 O(1)
+    double getMarketVolatility() const {
+        // 시장 변동성
+        return stockTable.volatility();  // 0.0 ~ 1.0
+    }
+
+    double getAverageVolume() const {
+        if (stockTable.empty()) return 0.0;
+
+        return stockTable.volumeSum() / stockTable.size();
+    }
+
+    // 전 종목 중 최대 거래량 비율
+    double getMaxVolumeRatio() const {
+        return stockTable.maxVolumeRatio();
+    }
+
+    void addTransaction(const Transaction& t) {
+        if (concurrentTrading) {
+            size_t thread = ThreadPool::currentThreadIndex();
+            pendingTransactions[thread].push_back(PendingTransaction{ concurrentAgent[thread], t });
+        }
+
+        else {
+            transactionHistory.append(t);
+        }
+    }
+
+    // 동시 매매 시작: 이후 endConcurrentTrading()까지 시세는 바뀌지 않아야 하며,
+    // 주문은 호출 스레드와 설정된 ThreadPool 작업자에서만 낸다.
+    void beginConcurrentTrading() {
+        size_t threads = pool ? pool->size() : 1;
+
+        concurrentAgent.assign(threads, 0);
+        pendingTransactions.resize(threads);
+        deferredOrders.resize(threads);
+        if (orderBooksEnabled) reserveOrderBooks();
+
+        concurrentTrading = true;
+    }
+
+    // 이 스레드에서 이제 매매할 에이전트 번호 (주문·거래 내역의 병합 순서 기준)
+    void setConcurrentAgent(uint32_t agent) { concurrentAgent[ThreadPool::currentThreadIndex()] = agent; }
+
+    // 동시 매매 중 쌓인 주문장 주문을 (에이전트 번호, 주문 순서) 순으로 체결.
+    // 종목은 샤드별로 나눠 병렬 처리하고 각 샤드는 같은 순서를 따르므로 스레드 수와 무관하게 동일한 결과.
+    // 모든 에이전트의 매매가 끝난 뒤 (병렬 구간 밖에서) 호출.
+    void matchDeferredOrders() {
+        matchOrder.clear();
+
+        for (size_t thread = 0; thread < deferredOrders.size(); ++thread) {
+            for (size_t k = 0; k < deferredOrders[thread].size(); ++k) matchOrder.push_back((uint64_t(thread) << 32) | k);
+        }
+
+        // 한 에이전트의 주문은 모두 한 스레드 버퍼에 주문 순으로 있으므로 안정 정렬로 순서 유지
+        stable_sort(matchOrder.begin(), matchOrder.end(), [this](uint64_t a, uint64_t b) {
+            return deferredOrder(a).agent < deferredOrder(b).agent;
+        });
+
+        auto matchShard = [this](size_t shard) {
+            vector<OrderBook::Fill>& fills = fillBuffer();
+
+            for (uint64_t ticket : matchOrder) {
+                DeferredOrder& order = deferredOrder(ticket);
+                if (static_cast<size_t>(order.id) % ORDER_SHARDS != shard) continue;
+
+                fills.clear();
+                int filled = getOrderBook(order.id).marketOrder(order.side, order.quantity, order.maxNotional, fills);
+
+                double notional = 0.0;
+                for (const OrderBook::Fill& f : fills) notional += f.price * f.quantity;
+
+                order.actual = Execution{ filled, filled > 0 ? notional / filled : 0.0, notional };
+            }
+        };
+
+        if (pool) {
+            pool->parallelFor(ORDER_SHARDS, matchShard);
+        }
+
+        else {
+            for (size_t shard = 0; shard < ORDER_SHARDS; ++shard) matchShard(shard);
+        }
+    }
+
+    // 잠정 체결 티켓의 실제 체결 (matchDeferredOrders() 이후 유효)
+    const Execution& deferredFill(uint64_t ticket) const { return deferredOrder(ticket).actual; }
+
+    // 동시 매매 마감: 거래 내역을 에이전트 번호 순으로 저널에 병합 (같은 에이전트 안에서는 기록 순서)
+    void endConcurrentTrading() {
+        concurrentTrading = false;
+
+        pendingMerge.clear();
+        for (vector<PendingTransaction>& buffer : pendingTransactions) {
+            pendingMerge.insert(pendingMerge.end(), buffer.begin(), buffer.end());
+            buffer.clear();
+        }
+
+        // 한 에이전트의 기록은 모두 한 스레드 버퍼에 순서대로 있으므로 안정 정렬로 순서 유지
+        stable_sort(pendingMerge.begin(), pendingMerge.end(), [](const PendingTransaction& a, const PendingTransaction& b) {
+            return a.agent < b.agent;
+        });
+
+        for (const PendingTransaction& p : pendingMerge) transactionHistory.append(p.transaction);
+
+        for (vector<DeferredOrder>& buffer : deferredOrders) buffer.clear();
+    }
+
+    void printMarketStatus() const {
+        PROFILE_SCOPE(Probe::PrintMarketStatus);
+
+        if (!Logger::enabled(LogLevel::Info)) return;
+
+        Logger::write(LogLevel::Info, LogCode::MarketSummary, { getMarketVolatility(), getAverageVolume() });
+
+        if (Logger::enabled(LogLevel::Verbose)) {
+            const SymbolTable& symbols = stockTable.getSymbols();
+
+            Logger::text(LogLevel::Verbose, "\n[종목별 현황]");
+
+            for (Stock* stock : allStocks) {
+                Logger::write(LogLevel::Verbose, LogCode::StockLine,
+                              { stock->getCurrentPrice(), stock->getFluctuationRate(),
+                                stock->getVolumeRatio(), stock->getAverageVolume() },
+                              0, stock->getId(), &symbols);
+
+                if (indicators) {
+                    size_t i = static_cast<size_t>(stock->getId());
+                    Logger::write(LogLevel::Verbose, LogCode::IndicatorLine,
+                                  { indicators->getMovingAverage(i), indicators->getVolatility(i), indicators->getDrawdown(i),
+                                    indicators->getAverageRange(i), indicators->getVolumeZ(i) },
+                                  static_cast<int64_t>(indicators->getWindow()));
+                }
+            }
+        }
+
+        Logger::text(LogLevel::Info, "=======================\n");
+    }
+
+    // 보존 중인 시세 이력의 종목별 요약 (시작/최종/최저/최고가)
+    void printPriceHistory() const {
+        if (!recordHistory || !Logger::enabled(LogLevel::Info)) return;
+
+        uint64_t retained = priceHistory.getEndDay() - priceHistory.getFirstDay();
+        Logger::write(LogLevel::Info, LogCode::HistorySummary,
+                      { static_cast<double>(priceHistory.memoryBytes()), static_cast<double>(priceHistory.rawBytes()) },
+                      static_cast<int64_t>(retained));
+
+        vector<MarketBar> bars;
+
+        for (Stock* stock : allStocks) {
+            if (!priceHistory.range(stock->getId(), priceHistory.getFirstDay(), priceHistory.getEndDay(), bars)) continue;
+            if (bars.empty()) continue;
+
+            double low = bars[0].price;
+            double high = bars[0].price;
+
+            for (const MarketBar& bar : bars) {
+                low = min(low, bar.price);
+                high = max(high, bar.price);
+            }
+
+            Logger::write(LogLevel::Info, LogCode::HistoryLine, { bars.front().price, bars.back().price, low, high },
+                          static_cast<int64_t>(bars.size()), stock->getId(), &stockTable.getSymbols());
+        }
+    }
+
+    void printTransactionHistory() const {
+        PROFILE_SCOPE(Probe::PrintTransactionHistory);
+
+        if (!Logger::enabled(LogLevel::Info)) return;
+
+        Logger::text(LogLevel::Info, "\n====== 거래 내역 ======");
+
+        transactionHistory.forEach([&](const Transaction& t) {
+            t.printLog(stockTable.getSymbols());
+        });
+
+        Logger::text(LogLevel::Info, "=======================\n");
+    }
+
+    const ArenaVector<Stock*>& getAllStocks() const { return allStocks; }
+    const StockTable& getStockTable() const { return stockTable; }
+    const TransactionJournal& getTransactionHistory() const { return transactionHistory; }
+
+    // 일별 시세 이력 기록 시작 (현재 상태를 오늘 일자로 기록). retentionDays = 0이면 무제한 보존.
+    void enableHistory(size_t retentionDays) {
+        recordHistory = true;
+        priceHistory.setRetention(retentionDays);
+        priceHistory.record(day, stockTable);
+    }
+
+    const PriceHistory& getPriceHistory() const { return priceHistory; }
+
+    // 종목별 이동 구간 지표 계산 시작 (다음 일자 마감부터 window일 구간으로 채워짐)
+    void enableIndicators(size_t window) {
+        indicators = make_unique<RollingIndicators>(window);
+        indicators->ensureStocks(stockTable);
+    }
+
+    // 이동 구간 지표 (사용하지 않으면 nullptr)
+    const RollingIndicators* getIndicators() const { return indicators.get(); }
+
+    // 매매를 주문장 체결로 전환 (기본은 현재가 무제한 체결)
+    void enableOrderBooks() { orderBooksEnabled = true; }
+
+    bool hasOrderBooks() const { return orderBooksEnabled; }
+
+    // 종목 수만큼 주문장 자리 확보 (동시 매매 중에는 크기가 바뀌지 않도록 시작 전에 호출)
+    void reserveOrderBooks() {
+        if (orderBooks.size() < stockTable.size()) {
+            orderBooks.resize(stockTable.size());
+            orderBookDay.resize(stockTable.size(), ~uint64_t(0));
+            orderBookPrice.resize(stockTable.size(), 0.0);
+        }
+    }
+
+    // 종목 주문장 (오늘 처음 접근하거나 현재가가 바뀌었으면 현재가 기준 시장조성 호가로 다시 채움)
+    OrderBook& getOrderBook(SymbolId id) {
+        size_t i = static_cast<size_t>(id);
+
+        reserveOrderBooks();
+
+        if (!orderBooks[i]) orderBooks[i] = make_unique<OrderBook>();
+
+        // 날이 바뀌었거나 (장중) 현재가가 움직였으면 호가를 다시 채움
+        if (orderBookDay[i] != day || orderBookPrice[i] != stockTable.getCurrentPrice(i)) {
+            seedOrderBook(*orderBooks[i], i);
+            orderBookDay[i] = day;
+            orderBookPrice[i] = stockTable.getCurrentPrice(i);
+        }
+
+        return *orderBooks[i];
+    }
+
+    // 시장가 주문 체결. 주문장이 꺼져 있으면 현재가로 전량 체결 (매수는 금액이 maxNotional을 넘으면 거부),
+    // 켜져 있으면 호가를 소진하며 체결하고 유동성·금액 상한이 부족하면 일부만 체결.
+    // 동시 매매 중 주문장 주문은 현재가로 잠정 체결해 티켓을 붙여 돌려주고, 실제 체결은 matchDeferredOrders()에서 한다.
+    Execution executeMarketOrder(SymbolId id, OrderSide side, int qty, double maxNotional) {
+        Stock* stock = getStockById(id);
+
+        if (!stock || qty <= 0) return Execution{ 0, 0.0, 0.0 };
+
+        if (!orderBooksEnabled || concurrentTrading) {
+            double price = stock->getCurrentPrice();
+            double cost = price * qty;
+
+            if (side == OrderSide::Buy && cost > maxNotional) return Execution{ 0, price, 0.0 };
+
+            Execution provisional{ qty, price, cost };
+
+            if (orderBooksEnabled) {
+                size_t thread = ThreadPool::currentThreadIndex();
+                vector<DeferredOrder>& orders = deferredOrders[thread];
+
+                provisional.ticket = (uint64_t(thread) << 32) | orders.size();
+                orders.push_back(DeferredOrder{ concurrentAgent[thread], id, side, qty, maxNotional, Execution{ 0, 0.0, 0.0 } });
+            }
+
+            return provisional;
+        }
+
+        vector<OrderBook::Fill>& fills = fillBuffer();
+        fills.clear();
+        int filled = getOrderBook(id).marketOrder(side, qty, maxNotional, fills);
+
+        double notional = 0.0;
+        for (const OrderBook::Fill& f : fills) notional += f.price * f.quantity;
+
+        return Execution{ filled, filled > 0 ? notional / filled : 0.0, notional };
+    }
+
+    // 거래 내역을 파일 저널로 기록 (기본은 메모리 저널). 종목을 모두 등록한 뒤 호출,
+    // 기존 저널의 종목 구성이 현재 시장과 다르면 실패
+    bool openJournal(const string& path) { return transactionHistory.open(path, stockTable.getSymbols()); }
+};
+
+// ============================================================
+// 팀원 A: MarketReplay (메모리 매핑 과거 시세 재생)
+// ============================================================
+// 시세 파일 형식 (리틀 엔디언):
+//   [Header 32바이트]
+//   [종목명: NUL 종료 문자열 stockCount개, 8바이트 경계까지 0으로 채움]
+//   [MarketBar 16바이트 x stockCount x dayCount]  (일자 우선: bars[day * stockCount + stock])
+// 파일 전체를 읽기 전용으로 매핑하고 bars(day)는 매핑 내부를 가리키는 포인터를 그대로 반환한다.
+class MarketReplay {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t stockCount;
+        uint64_t dayCount;
+        uint64_t namesBytes;    // 패딩 포함 종목명 구간 크기
+    };
+
+    static_assert(sizeof(Header) == 32, "시세 파일 헤더는 32바이트 고정");
+
+    static constexpr char MAGIC[8] = { 'M', 'K', 'T', 'B', 'A', 'R', 'S', '\0' };
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    int fd;
+    const char* base;
+    size_t mappedBytes;
+    vector<string> names;
+    const MarketBar* barData;
+
+    const Header* header() const { return reinterpret_cast<const Header*>(base); }
+
+public:
+    MarketReplay()
+        : fd(-1), base(nullptr), mappedBytes(0), barData(nullptr) {
+    }
+
+    ~MarketReplay() {
+        close();
+    }
+
+    MarketReplay(const MarketReplay&) = delete;
+    MarketReplay& operator=(const MarketReplay&) = delete;
+
+    bool open(const string& path) {
+        close();
+
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close();
+            return false;
+        }
+
+        mappedBytes = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (p == MAP_FAILED) {
+            base = nullptr;
+            close();
+            return false;
+        }
+
+        base = static_cast<const char*>(p);
+
+        const Header* h = header();
+
+        // namesBytes는 파일에서 읽은 값이므로 오프셋을 더하기 전에 남은 크기와 비교 (덧셈 오버플로 방지)
+        if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION ||
+            h->namesBytes % 8 != 0 || h->namesBytes > mappedBytes - sizeof(Header)) {
+            close();
+            return false;
+        }
+
+        size_t barsOffset = sizeof(Header) + static_cast<size_t>(h->namesBytes);
+
+        if ((mappedBytes - barsOffset) / sizeof(MarketBar) / max<uint32_t>(h->stockCount, 1) < h->dayCount) {
+            close();
+            return false;
+        }
+
+        // 종목명 (파일 순서 == 재생 시 SymbolId)
+        const char* cursor = base + sizeof(Header);
+        const char* namesEnd = base + barsOffset;
+
+        for (uint32_t i = 0; i < h->stockCount; ++i) {
+            const char* end = static_cast<const char*>(memchr(cursor, '\0', namesEnd - cursor));
+
+            if (!end) {
+                close();
+                return false;
+            }
+
+            names.emplace_back(cursor, end);
+            cursor = end + 1;
+        }
+
+        barData = reinterpret_cast<const MarketBar*>(base + barsOffset);
+        madvise(const_cast<char*>(base), mappedBytes, MADV_SEQUENTIAL);
+
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<char*>(base), mappedBytes);
+        if (fd >= 0) ::close(fd);
+
+        fd = -1;
+        base = nullptr;
+        mappedBytes = 0;
+        names.clear();
+        barData = nullptr;
+    }
+
+    size_t getStockCount() const { return names.size(); }
+
+    size_t getDayCount() const { return base ? static_cast<size_t>(header()->dayCount) : 0; }
+
+    const string& getName(size_t i) const { return names[i]; }
+
+    // day일의 전 종목 시세 (매핑 메모리를 직접 가리킴)
+    const MarketBar* bars(size_t day) const { return barData + day * names.size(); }
+
+    // 빈 Market에 파일의 종목을 0일차 시세로 등록 (SymbolId == 파일 내 순서)
+    bool populate(Market& market) const {
+        if (!market.getAllStocks().empty() || getDayCount() == 0) return false;
+
+        const MarketBar* first = bars(0);
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            market.addStock(names[i], first[i].price, first[i].volume);
+        }
+
+        return market.getAllStocks().size() == names.size();
+    }
+
+    // bars: 일자 우선 [day][stock] 배열
+    static bool write(const string& path, const vector<string>& stockNames, const vector<MarketBar>& bars) {
+        size_t stocks = stockNames.size();
+        if (stocks == 0 || bars.size() % stocks != 0) return false;
+
+        string namesBlock;
+        for (const string& name : stockNames) {
+            namesBlock += name;
+            namesBlock += '\0';
+        }
+        namesBlock.resize((namesBlock.size() + 7) / 8 * 8, '\0');
+
+        Header h;
+        memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.stockCount = static_cast<uint32_t>(stocks);
+        h.dayCount = bars.size() / stocks;
+        h.namesBytes = namesBlock.size();
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(namesBlock.data(), namesBlock.size());
+        out.write(reinterpret_cast<const char*>(bars.data()), bars.size() * sizeof(MarketBar));
+
+        return static_cast<bool>(out);
+    }
+
+    // CSV 일자 순서: 숫자로만 된 일자는 수 크기로 (앞의 0 무시, "9" < "10"), 그 밖의 일자는 문자열 순서로 비교
+    struct DayKeyLess {
+        static bool isNumber(const string& key) {
+            return !key.empty() && all_of(key.begin(), key.end(), [](char c) { return c >= '0' && c <= '9'; });
+        }
+
+        bool operator()(const string& a, const string& b) const {
+            if (!isNumber(a) || !isNumber(b)) return a < b;
+
+            size_t za = min(a.find_first_not_of('0'), a.size());
+            size_t zb = min(b.find_first_not_of('0'), b.size());
+
+            if (a.size() - za != b.size() - zb) return a.size() - za < b.size() - zb;
+
+            return a.compare(za, string::npos, b, zb, string::npos) < 0;
+        }
+    };
+
+    // CSV(일자,종목명,종가,거래량; 첫 줄 헤더 허용) -> 시세 파일 변환.
+    // 일자는 정수(일차) 또는 정렬 가능한 문자열(예: 2024-01-02)이며 한 파일에서 섞어 쓸 수 없다.
+    // 빠진 시세는 직전 값을 이어 쓰고, 늦게 상장된 종목의 앞쪽 일자는 첫 시세로 채운다.
+    static bool convertCsv(const string& csvPath, const string& outPath, string& error) {
+        ifstream in(csvPath);
+
+        if (!in) {
+            error = "CSV 파일을 열 수 없음";
+            return false;
+        }
+
+        unordered_map<string, uint32_t> stockIndex;
+        vector<string> stockNames;
+        map<string, vector<pair<uint32_t, MarketBar>>, DayKeyLess> byDay;   // 일자 -> (종목, 시세)
+        size_t numericDays = 0;
+
+        string line;
+        size_t lineNo = 0;
+
+        while (getline(in, line)) {
+            ++lineNo;
+
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            string fields[4];
+            size_t start = 0;
+            int f = 0;
+
+            for (; f < 4; ++f) {
+                size_t comma = line.find(',', start);
+                fields[f] = line.substr(start, comma == string::npos ? string::npos : comma - start);
+
+                if (comma == string::npos) {
+                    ++f;
+                    break;
+                }
+
+                start = comma + 1;
+            }
+
+            char* endPrice = nullptr;
+            char* endVolume = nullptr;
+            double price = f == 4 ? strtod(fields[2].c_str(), &endPrice) : 0.0;
+            double vol = f == 4 ? strtod(fields[3].c_str(), &endVolume) : 0.0;
+
+            if (f != 4 || endPrice == fields[2].c_str() || endVolume == fields[3].c_str()) {
+                if (lineNo == 1) continue;  // 헤더 줄
+
+                error = "잘못된 CSV 줄: " + to_string(lineNo);
+                return false;
+            }
+
+            auto it = stockIndex.find(fields[1]);
+
+            if (it == stockIndex.end()) {
+                it = stockIndex.emplace(fields[1], static_cast<uint32_t>(stockNames.size())).first;
+                stockNames.push_back(fields[1]);
+            }
+
+            auto day = byDay.find(fields[0]);
+
+            if (day == byDay.end()) {
+                day = byDay.emplace(fields[0], vector<pair<uint32_t, MarketBar>>()).first;
+                if (DayKeyLess::isNumber(fields[0])) ++numericDays;
+            }
+
+            day->second.push_back({ it->second, MarketBar{ price, vol } });
+        }
+
+        if (byDay.empty()) {
+            error = "시세가 없음";
+            return false;
+        }
+
+        // 정수 일자와 문자열 일자가 섞이면 순서를 정할 수 없음
+        if (numericDays != 0 && numericDays != byDay.size()) {
+            error = "일자 형식이 섞여 있음 (정수 일차와 문자열 날짜)";
+            return false;
+        }
+
+        size_t stocks = stockNames.size();
+        vector<MarketBar> bars(byDay.size() * stocks, MarketBar{ 0.0, 0.0 });
+        vector<size_t> firstDay(stocks, SIZE_MAX);     // 종목별 첫 시세 일자 (종가 0도 유효한 시세)
+        size_t day = 0;
+
+        for (const auto& kv : byDay) {
+            MarketBar* row = &bars[day * stocks];
+
+            // 직전 일자 값을 이어 쓰고 이 날의 시세로 덮어씀
+            if (day > 0) copy(row - stocks, row, row);
+
+            for (const auto& entry : kv.second) {
+                row[entry.first] = entry.second;
+                firstDay[entry.first] = min(firstDay[entry.first], day);
+            }
+
+            ++day;
+        }
+
+        // 첫 시세가 늦게 나온 종목은 첫 값으로 앞쪽을 채움
+        for (size_t s = 0; s < stocks; ++s) {
+            for (size_t d = 0; d < firstDay[s]; ++d) {
+                bars[d * stocks + s] = bars[firstDay[s] * stocks + s];
+            }
+        }
+
+        if (!write(outPath, stockNames, bars)) {
+            error = "시세 파일을 쓸 수 없음";
+            return false;
+        }
+
+        return true;
+    }
+};
+
+// ============================================================
+// 공통: StrategyParams (전략 매개변수)
+// ============================================================
+// 상태별 전략과 상태 전환 기준값. 기본값은 명세서 값이며, 매개변수 탐색(ParameterSweep)에서 바꿔 가며 평가한다.
+struct StrategyParams {
+    double targetProfitRate = 0.10;     // NormalState: 갭 포지션 목표 수익률 10%
+    double stopLossRate = -0.20;        // NormalState: 갭 포지션 손절 기준 -20%
+    double investmentRatio = 0.50;      // DisruptedState: 매수 1회 투자 비율 (현금 대비)
+    int maxPositions = 3;               // DisruptedState: 최대 갭 포지션 수
+    double threshold = 70.0;            // DisruptionDetector: Disrupted 전환 점수
+    double recoveryThreshold = 50.0;    // DisruptionDetector: Normal 복귀 점수
+};
+
+// ============================================================
+// 팀원 B: Position 구조체
+// ============================================================
+struct Position {
+    Stock* stock;
+    int quantity;
+    double avgBuyPrice;
+    SimTime buyTimestamp;   // 마지막 매수 체결 가상 시각
+
+    // 생성자
+    Position(Stock* s = nullptr, int qty = 0, double price = 0.0, SimTime buyTime = 0)
+        : stock(s), quantity(qty), avgBuyPrice(price), buyTimestamp(buyTime) {
+    }
+};
+
+// ============================================================
+// 팀원 B: PositionBook (압축 배열 포지션 저장소)
+// ============================================================
+// 보유 포지션을 연속 배열에 빈틈 없이 저장하고, SymbolId -> 배열 위치 표로 O(1) 조회한다.
+// 삭제는 마지막 원소를 빈자리로 옮기는 방식(swap-erase)이라 배열 위치는 바뀔 수 있으므로
+// 포지션을 가리키는 안정적인 핸들은 SymbolId이다.
+// 평가 금액과 취득 원가는 누계로 들고 있어 조회가 O(1)이다. 포지션이 바뀌면 그 몫만 더하고 빼며,
+// 시세가 바뀐 뒤 mark()는 포지션마다 (새 현재가 - 평가 기준가) x 수량만큼 누계를 고치면서
+// 감시 수익률 구간을 벗어난 종목 목록(crossings)을 함께 만든다.
+class PositionBook {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+private:
+    ArenaVector<SymbolId> symbols;  // 압축 배열: k번째 포지션의 종목
+    ArenaVector<Position> positions;    // 압축 배열: k번째 포지션
+    ArenaVector<double> marks;          // 압축 배열: k번째 포지션의 평가 기준가 (마지막 평가 시점 현재가)
+
+    // 감시 구간 경계를 가격으로 환산해 둔 값 (평가 때 나눗셈 없이 비교)
+    struct Trigger {
+        double lowerPrice;
+        double upperPrice;
+    };
+
+    ArenaVector<Trigger> triggers;  // 압축 배열: k번째 포지션의 감시 가격
+    ArenaVector<int32_t> slotOf;    // SymbolId -> 압축 위치 (-1 = 미보유)
+
+    double value = 0.0;             // 평가 금액 누계: 평가 기준가 x 수량
+    double cost = 0.0;              // 취득 원가 누계: 평균 단가 x 수량
+
+    // 감시 수익률 구간: 수익률 <= lowerReturn 또는 >= upperReturn이면 crossings에 기록
+    double lowerReturn = -numeric_limits<double>::infinity();
+    double upperReturn = numeric_limits<double>::infinity();
+    ArenaVector<SymbolId> crossings;
+    bool crossingsStale = false;    // 마지막 mark() 이후 포지션이 바뀜
+
+    size_t slot(SymbolId id) const { return static_cast<size_t>(slotOf[static_cast<size_t>(id)]); }
+
+    // 수익률 = (가격 - 평균 단가) / 평균 단가 가 구간 경계에 닿는 가격
+    Trigger triggerFor(double avgBuyPrice) const {
+        if (avgBuyPrice <= 0.0) return Trigger{ -numeric_limits<double>::infinity(), numeric_limits<double>::infinity() };
+
+        return Trigger{ avgBuyPrice * (1.0 + lowerReturn), avgBuyPrice * (1.0 + upperReturn) };
+    }
+
+public:
+    explicit PositionBook(Arena* arena = nullptr)
+        : symbols(ArenaAllocator<SymbolId>(arena)), positions(ArenaAllocator<Position>(arena)),
+          marks(ArenaAllocator<double>(arena)), triggers(ArenaAllocator<Trigger>(arena)),
+          slotOf(ArenaAllocator<int32_t>(arena)), crossings(ArenaAllocator<SymbolId>(arena)) {
+    }
+
+    size_t size() const { return positions.size(); }
+    bool empty() const { return positions.empty(); }
+
+    SymbolId symbolAt(size_t k) const { return symbols[k]; }
+    const Position& at(size_t k) const { return positions[k]; }
+
+    const Position* find(SymbolId id) const {
+        size_t i = static_cast<size_t>(id);
+        if (id < 0 || i >= slotOf.size() || slotOf[i] < 0) return nullptr;
+        return &positions[static_cast<size_t>(slotOf[i])];
+    }
+
+    bool contains(SymbolId id) const { return find(id) != nullptr; }
+
+    // 매수 체결 반영: 보유 중이면 가중 평균 단가로 합산. markPrice = 현재가 (이 포지션의 평가 기준가를 갱신), at = 체결 시각
+    void add(SymbolId id, Stock* stock, int qty, double price, double markPrice, SimTime at) {
+        if (qty <= 0) return;
+
+        if (!contains(id)) {
+            size_t i = static_cast<size_t>(id);
+            if (i >= slotOf.size()) slotOf.resize(i + 1, -1);
+
+            slotOf[i] = static_cast<int32_t>(positions.size());
+            symbols.push_back(id);
+            positions.push_back(Position(stock, qty, price, at));
+            marks.push_back(markPrice);
+            triggers.push_back(triggerFor(price));
+
+            value += markPrice * qty;
+            cost += price * qty;
+        }
+
+        else {
+            size_t k = slot(id);
+            Position& pos = positions[k];
+            int newQty = pos.quantity + qty;
+
+            value += markPrice * newQty - marks[k] * pos.quantity;
+            cost += price * qty;
+            marks[k] = markPrice;
+
+            pos.avgBuyPrice = (pos.avgBuyPrice * pos.quantity + price * qty) / newQty;
+            pos.quantity = newQty;
+            pos.buyTimestamp = at;
+            triggers[k] = triggerFor(pos.avgBuyPrice);
+        }
+
+        crossingsStale = true;
+    }
+
+    // 매도 체결 반영: 수량 감소, 0이 되면 마지막 포지션을 빈자리로 옮겨 삭제 (다른 종목의 압축 위치가 바뀔 수 있음)
+    bool reduce(SymbolId id, int qty) {
+        if (!contains(id) || qty <= 0) return false;
+
+        size_t k = slot(id);
+        Position& pos = positions[k];
+        qty = min(qty, pos.quantity);
+
+        value -= marks[k] * qty;
+        cost -= pos.avgBuyPrice * qty;
+        pos.quantity -= qty;
+        crossingsStale = true;
+
+        if (pos.quantity > 0) return true;
+
+        size_t last = positions.size() - 1;
+
+        if (k != last) {
+            symbols[k] = symbols[last];
+            positions[k] = positions[last];
+            marks[k] = marks[last];
+            triggers[k] = triggers[last];
+            slotOf[static_cast<size_t>(symbols[k])] = static_cast<int32_t>(k);
+        }
+
+        symbols.pop_back();
+        positions.pop_back();
+        marks.pop_back();
+        triggers.pop_back();
+        slotOf[static_cast<size_t>(id)] = -1;
+
+        // 빈 장부는 누계 오차를 0으로 정리
+        if (positions.empty()) value = cost = 0.0;
+
+        return true;
+    }
+
+    // 매수 체결 정정: 수량을 qtyDelta, 취득 원가를 costDelta만큼 고치고 평균 단가를 다시 계산 (수량이 0 이하가 되면 삭제)
+    void revise(SymbolId id, int qtyDelta, double costDelta) {
+        if (!contains(id)) return;
+
+        size_t k = slot(id);
+        Position& pos = positions[k];
+        int newQty = pos.quantity + qtyDelta;
+
+        if (newQty <= 0) {
+            reduce(id, pos.quantity);
+            return;
+        }
+
+        value += marks[k] * qtyDelta;
+        cost += costDelta;
+
+        pos.avgBuyPrice = (pos.avgBuyPrice * pos.quantity + costDelta) / newQty;
+        pos.quantity = newQty;
+        triggers[k] = triggerFor(pos.avgBuyPrice);
+        crossingsStale = true;
+    }
+
+    void setReturnBand(double lower, double upper) {
+        lowerReturn = lower;
+        upperReturn = upper;
+        crossingsStale = true;
+
+        for (size_t k = 0; k < positions.size(); ++k) triggers[k] = triggerFor(positions[k].avgBuyPrice);
+    }
+
+    // 시세 반영: prices[SymbolId] = 현재가 (StockTable::priceData()). 평가 누계를 차이만큼 고치고 crossings 재구성.
+    void mark(const double* prices) {
+        double delta = 0.0;
+        crossings.clear();
+
+        for (size_t k = 0; k < positions.size(); ++k) {
+            double price = prices[symbols[k]];
+
+            delta += (price - marks[k]) * positions[k].quantity;
+            marks[k] = price;
+
+            if (price >= triggers[k].upperPrice || price <= triggers[k].lowerPrice) crossings.push_back(symbols[k]);
+        }
+
+        value += delta;
+        crossingsStale = false;
+    }
+
+    bool needsMark() const { return crossingsStale; }
+
+    // 마지막 평가 기준 O(1) 조회
+    double marketValue() const { return value; }
+    double unrealizedProfit() const { return value - cost; }
+    const ArenaVector<SymbolId>& getCrossings() const { return crossings; }
+
+    // 마지막 평가 기준 수익률 (미보유 0)
+    double markedReturn(SymbolId id) const {
+        const Position* pos = find(id);
+        if (!pos || pos->avgBuyPrice <= 0.0) return 0.0;
+
+        return (marks[slot(id)] - pos->avgBuyPrice) / pos->avgBuyPrice;
+    }
+};
+
+// ============================================================
+// 팀원 B: Trader 클래스
+// ============================================================
+// 포지션은 SymbolId를 핸들로 하는 PositionBook에 관리 (문자열 해시/노드 할당 없음)
+
+class Trader {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+private:
+    string username;
+    double cash;
+    PositionBook portfolio;
+    PositionBook gapPositions;
+    ArenaPtr<DisruptionDetector> detector;
+    double realizedGapProfit;   // 청산된 갭 포지션 누적 손익
+    StrategyParams params;
+
+    // 마지막 평가 시점의 시세표와 가격 버전 (같으면 평가 누계가 최신)
+    const StockTable* markedTable;
+    uint64_t markedVersion;
+
+    // 동시 매매 중 주문장 주문의 잠정 체결 (settleDeferredOrders()에서 실제 체결로 정산)
+    struct DeferredFill {
+        Transaction trade;      // 잠정 체결 기준 거래 내역
+        uint64_t ticket;
+        double avgBuyPrice;     // 매도: 체결 전 평균 단가
+        SimTime buyTimestamp;   // 매도: 체결 전 매수 시각
+    };
+
+    ArenaVector<DeferredFill> deferredFills;
+
+    // 가중 평균 단가로 포지션 추가/갱신 (평가 기준가 = 현재가, 매수 시각 = 시장 시계)
+    static void addToPosition(PositionBook& positions, Stock* stock, int qty, double price, const Market& m) {
+        positions.add(stock->getId(), stock, qty, price, stock->getCurrentPrice(), m.now());
+    }
+
+    // 거래 내역 기록. 잠정 체결이면 정산 때 실제 체결로 기록하도록 미룬다 (매도는 체결 전 포지션 정보를 함께 보관)
+    void recordTrade(const Transaction& t, const Market::Execution& fill, Market& m,
+                     double avgBuyPrice = 0.0, SimTime buyTimestamp = 0) {
+        if (fill.ticket == Market::NO_TICKET) m.addTransaction(t);
+        else deferredFills.push_back(DeferredFill{ t, fill.ticket, avgBuyPrice, buyTimestamp });
+    }
+
+public:
+    // arena를 넘기면 포지션 배열, 탐지기와 상태별 작업 버퍼를 그 안에 둔다
+    Trader(const string& name, double initialCash, const StrategyParams& params = StrategyParams(), Arena* arena = nullptr)
+        : username(name), cash(initialCash), portfolio(arena), gapPositions(arena), realizedGapProfit(0.0), params(params),
+          markedTable(nullptr), markedVersion(0), deferredFills(ArenaAllocator<DeferredFill>(arena)) {
+        detector = makeArenaPtr<DisruptionDetector>(arena, params, arena);
+        gapPositions.setReturnBand(params.stopLossRate, params.targetProfitRate);
+    }
+
+    const StrategyParams& getParams() const { return params; }
+
+    bool buy(SymbolId id, int qty, Market& m) {
+        PROFILE_SCOPE(Probe::Buy);
+
+        if (qty <= 0) return false;
+
+        Stock* stock = m.getStockById(id);
+
+        if (!stock) return false;
+
+        Market::Execution fill = m.executeMarketOrder(id, OrderSide::Buy, qty, cash);
+
+        if (fill.quantity <= 0) return false;
+
+        // 거래 내역 기록
+        Transaction t(id, TradeType::Buy, fill.quantity, fill.avgPrice, false, m.now());
+        t.setPartialFill(fill.quantity < qty);
+        recordTrade(t, fill, m);
+
+        // 포트폴리오 업데이트 (가중 평균 단가)
+        addToPosition(portfolio, stock, fill.quantity, fill.avgPrice, m);
+
+        // 현금 차감
+        cash -= fill.notional;
+
+        return true;
+    }
+
+    bool buy(const string& stockName, int qty, Market& m) {
+        return buy(m.findSymbol(stockName), qty, m);
+    }
+
+    bool sell(SymbolId id, int qty, Market& m) {
+        PROFILE_SCOPE(Probe::Sell);
+
+        if (qty <= 0) return false;
+
+        const Position* held = portfolio.find(id);
+
+        if (!held) return false;
+
+        const Position& pos = *held;
+
+        if (qty > pos.quantity) return false;
+
+        Stock* stock = pos.stock ? pos.stock : m.getStockById(id);
+
+        if (!stock) return false;
+
+        Market::Execution fill = m.executeMarketOrder(id, OrderSide::Sell, qty, numeric_limits<double>::infinity());
+
+        if (fill.quantity <= 0) return false;
+
+        // 거래 내역 기록
+        Transaction t(id, TradeType::Sell, fill.quantity, fill.avgPrice, false, m.now());
+        t.setPartialFill(fill.quantity < qty);
+        recordTrade(t, fill, m, pos.avgBuyPrice, pos.buyTimestamp);
+
+        // 포지션 및 현금 업데이트 (수량이 0이 되면 삭제)
+        portfolio.reduce(id, fill.quantity);
+
+        cash += fill.notional;
+
+        return true;
+    }
+
+    bool sell(const string& stockName, int qty, Market& m) {
+        return sell(m.findSymbol(stockName), qty, m);
+    }
+
+    void autoTrade(Market& m);  // DisruptionDetector 정의 후 구현
+
+    bool buyGapPosition(SymbolId id, int qty, Market& m) {
+        PROFILE_SCOPE(Probe::BuyGapPosition);
+
+        if (qty <= 0) return false;
+
+        Stock* stock = m.getStockById(id);
+
+        if (!stock) return false;
+
+        Market::Execution fill = m.executeMarketOrder(id, OrderSide::Buy, qty, cash);
+
+        if (fill.quantity <= 0) return false;
+
+        addToPosition(gapPositions, stock, fill.quantity, fill.avgPrice, m);
+
+        Transaction t(id, TradeType::GapBuy, fill.quantity, fill.avgPrice, true, m.now());
+        t.setPartialFill(fill.quantity < qty);
+        recordTrade(t, fill, m);
+
+        cash -= fill.notional;
+
+        return true;
+    }
+
+    bool buyGapPosition(const string& stockName, int qty, Market& m) {
+        return buyGapPosition(m.findSymbol(stockName), qty, m);
+    }
+
+    void closeAllGapPositions(Market& m) {
+        // 뒤에서부터 청산: swap-erase로 당겨오는 원소는 이미 처리한 뒤쪽 원소뿐
+        for (size_t k = gapPositions.size(); k-- > 0;) {
+            closeGapPosition(gapPositions.symbolAt(k), m);
+        }
+    }
+
+    bool closeGapPosition(SymbolId id, Market& m) {
+        PROFILE_SCOPE(Probe::CloseGapPosition);
+
+        const Position* held = gapPositions.find(id);
+
+        if (!held) return false;
+
+        const Position& pos = *held;
+
+        if (pos.quantity <= 0) return false;
+
+        Stock* stock = pos.stock ? pos.stock : m.getStockById(id);
+
+        if (!stock) return false;
+
+        int qty = pos.quantity;
+        Market::Execution fill = m.executeMarketOrder(id, OrderSide::Sell, qty, numeric_limits<double>::infinity());
+
+        if (fill.quantity <= 0) return false;
+
+        double avgBuyPrice = pos.avgBuyPrice;
+
+        // 수익률 계산 (체결된 수량 기준)
+        double profitRate = (fill.avgPrice - avgBuyPrice) / avgBuyPrice;
+        double profitAmount = (fill.avgPrice - avgBuyPrice) * fill.quantity;
+
+        Transaction t(id, TradeType::GapSell, fill.quantity, fill.avgPrice, true, m.now());
+        t.setProfitInfo(profitRate, profitAmount);
+        t.setPartialFill(fill.quantity < qty);
+        recordTrade(t, fill, m, avgBuyPrice, pos.buyTimestamp);
+
+        // 일부만 체결되면 남은 수량은 갭 포지션으로 유지
+        gapPositions.reduce(id, fill.quantity);
+
+        cash += fill.notional;
+        realizedGapProfit += profitAmount;
+
+        return true;
+    }
+
+    bool closeGapPosition(const string& stockName, Market& m) {
+        return closeGapPosition(m.findSymbol(stockName), m);
+    }
+
+    // 잠정 체결을 실제 체결로 정산: 포지션·현금·갭 손익을 차이만큼 고치고 실제 체결 기준으로 거래 내역 기록.
+    // Market::matchDeferredOrders() 이후, 동시 매매를 마감하기 전에 호출
+    void settleDeferredOrders(Market& m) {
+        for (const DeferredFill& d : deferredFills) {
+            const Transaction& t = d.trade;
+            const Market::Execution& actual = m.deferredFill(d.ticket);
+            SymbolId id = t.getSymbolId();
+            int provisionalQty = t.getQuantity();
+            double provisionalNotional = t.getTotalAmount();
+            PositionBook& book = t.getIsGapTrade() ? gapPositions : portfolio;
+
+            if (!t.isClose()) {
+                // 매수: 체결되지 않은 수량과 금액 차이를 포지션과 현금에서 되돌림
+                book.revise(id, actual.quantity - provisionalQty, actual.notional - provisionalNotional);
+                cash += provisionalNotional - actual.notional;
+            }
+
+            else {
+                // 매도: 팔리지 않은 수량은 체결 전 평균 단가로 포지션에 되돌림
+                int unsold = provisionalQty - actual.quantity;
+                Stock* stock = m.getStockById(id);
+
+                if (unsold > 0 && stock) book.add(id, stock, unsold, d.avgBuyPrice, stock->getCurrentPrice(), d.buyTimestamp);
+
+                cash += actual.notional - provisionalNotional;
+
+                if (t.getType() == TradeType::GapSell) {
+                    realizedGapProfit += (actual.avgPrice - d.avgBuyPrice) * actual.quantity - t.getProfitAmount();
+                }
+            }
+
+            if (actual.quantity <= 0) continue;
+
+            Transaction settled(id, t.getType(), actual.quantity, actual.avgPrice, t.getIsGapTrade(), t.getTimestamp());
+            settled.setPartialFill(t.getIsPartialFill() || actual.quantity < provisionalQty);
+
+            if (t.getType() == TradeType::GapSell) {
+                settled.setProfitInfo((actual.avgPrice - d.avgBuyPrice) / d.avgBuyPrice,
+                                      (actual.avgPrice - d.avgBuyPrice) * actual.quantity);
+            }
+
+            m.addTransaction(settled);
+        }
+
+        deferredFills.clear();
+    }
+
+    bool hasOpenGapPositions() const {
+        return !gapPositions.empty();
+    }
+
+    int getPositionQuantity(SymbolId id) const {
+        int qty = 0;
+
+        if (const Position* normal = portfolio.find(id)) {
+            qty += normal->quantity;
+        }
+
+        if (const Position* gap = gapPositions.find(id)) {
+            qty += gap->quantity;
+        }
+
+        return qty;
+    }
+
+    // 시세가 바뀌었거나 포지션이 바뀐 뒤 처음 부를 때만 평가 누계를 현재가로 갱신 (그 외에는 O(1))
+    void markToMarket(const Market& m) {
+        const StockTable& table = m.getStockTable();
+
+        if (markedTable == &table && markedVersion == table.getPriceVersion() &&
+            !portfolio.needsMark() && !gapPositions.needsMark()) return;
+
+        portfolio.mark(table.priceData());
+        gapPositions.mark(table.priceData());
+        markedTable = &table;
+        markedVersion = table.getPriceVersion();
+    }
+
+    // 현금 + 일반 포트폴리오 가치 + 갭 포지션 가치
+    double getTotalAssetValue(Market& m) {
+        markToMarket(m);
+
+        return cash + portfolio.marketValue() + gapPositions.marketValue();
+    }
+
+    double getGapPositionProfit(SymbolId id) const {
+        const Position* held = gapPositions.find(id);
+
+        if (!held) return 0.0;
+
+        const Position& pos = *held;
+
+        if (pos.quantity <= 0 || pos.avgBuyPrice <= 0.0) return 0.0;
+
+        if (!pos.stock) return 0.0;
+
+        double currentPrice = pos.stock->getCurrentPrice();
+
+        // 수익률 = (현재가 - 평균 매수가) / 평균 매수가
+        double profitRate = (currentPrice - pos.avgBuyPrice) / pos.avgBuyPrice;
+
+        return profitRate;
+    }
+    
+    double getCash() const {
+        return cash;
+    }
+
+    // 갭 트레이딩 손익 = 청산 손익 누계 + 보유 중인 갭 포지션 평가손익
+    double getGapTradeProfit(Market& m) {
+        markToMarket(m);
+
+        return realizedGapProfit + gapPositions.unrealizedProfit();
+    }
+
+    int getStateTransitionCount() const;  // DisruptionDetector 정의 후 구현
+
+    const DisruptionDetector& getDetector() const { return *detector; }
+
+    const PositionBook& getPortfolio() const {
+        return portfolio;
+    }
+
+    const PositionBook& getGapPositions() const {
+        return gapPositions;
+    }
+
+    int getGapPositionCount() const {
+        return static_cast<int>(gapPositions.size());
+    }
+
+    void printGapPositionStatus() const {
+        PROFILE_SCOPE(Probe::PrintGapPositionStatus);
+
+        if (gapPositions.empty() || !Logger::enabled(LogLevel::Verbose)) return;
+
+        Logger::text(LogLevel::Verbose, "\n[갭 포지션 현황]");
+        for (size_t k = 0; k < gapPositions.size(); ++k) {
+            const Position& pos = gapPositions.at(k);
+            if (!pos.stock || pos.quantity <= 0) continue;
+
+            logPositionLine(pos);
+        }
+    }
+
+    void printPortfolioStatus() const {
+        PROFILE_SCOPE(Probe::PrintPortfolioStatus);
+
+        if (portfolio.empty() || !Logger::enabled(LogLevel::Verbose)) return;
+
+        Logger::text(LogLevel::Verbose, "\n[포트폴리오 현황]");
+        double totalProfit = 0.0;
+        for (size_t k = 0; k < portfolio.size(); ++k) {
+            const Position& pos = portfolio.at(k);
+            if (!pos.stock || pos.quantity <= 0) continue;
+
+            totalProfit += logPositionLine(pos);
+        }
+        Logger::write(LogLevel::Verbose, LogCode::PortfolioTotal, { totalProfit });
+    }
+
+    // 포지션 한 줄 로그, 평가손익 반환
+    static double logPositionLine(const Position& pos) {
+        double currentPrice = pos.stock->getCurrentPrice();
+        double profitRate = (currentPrice - pos.avgBuyPrice) / pos.avgBuyPrice;
+        double profitAmount = (currentPrice - pos.avgBuyPrice) * pos.quantity;
+
+        Logger::write(LogLevel::Verbose, LogCode::PositionLine,
+                      { pos.avgBuyPrice, currentPrice, profitRate, profitAmount },
+                      pos.quantity, pos.stock->getId(), &pos.stock->getSymbols());
+
+        return profitAmount;
+    }
+};
+
+// ============================================================
+// 팀원 C: MarketState 추상 클래스
+// ============================================================
+enum class StateId : uint8_t {
+    Normal,
+    Disrupted
+};
+
+static constexpr size_t STATE_COUNT = 2;
+
+inline const char* stateName(StateId id) {
+    return id == StateId::Disrupted ? "Disrupted" : "Normal";
+}
+
+class MarketState {
+public:
+    virtual void handle(Trader& t, Market& m) = 0;
+    virtual string getStateName() const = 0;
+    virtual StateId getStateId() const = 0;
+    virtual ~MarketState() {}
+};
+
+// ============================================================
+// 팀원 C: NormalState 클래스
+// ============================================================
+class NormalState : public MarketState {
+private:
+    ArenaVector<pair<SymbolId, bool>> toClose;  // 청산 대상 버퍼 (종목 ID, 목표수익 여부 - false면 손절), 매일 재사용
+
+public:
+    explicit NormalState(Arena* arena = nullptr)
+        : toClose(ArenaAllocator<pair<SymbolId, bool>>(arena)) {
+    }
+
+    void handle(Trader& t, Market& m) override {
+        // 보수적 리밸런싱, 갭 포지션 청산 검사
+        checkGapPositionRecovery(t, m);
+    }
+
+    string getStateName() const override { return "Normal"; }
+
+    StateId getStateId() const override { return StateId::Normal; }
+
+    void checkGapPositionRecovery(Trader& t, Market& m) {
+        // 평가 때 감시 구간(손절 ~ 목표 수익률)을 벗어난 갭 포지션만 청산 대상 -> 목표 달성 또는 손절
+        t.markToMarket(m);
+
+        const ArenaVector<SymbolId>& crossings = t.getGapPositions().getCrossings();
+        if (crossings.empty()) return;
+
+        const StrategyParams& params = t.getParams();
+        toClose.clear();
+
+        for (SymbolId id : crossings) {
+            toClose.push_back({id, t.getGapPositions().markedReturn(id) >= params.targetProfitRate});
+        }
+
+        for (const auto& item : toClose) {
+            SymbolId id = item.first;
+            double profitRate = t.getGapPositionProfit(id);
+
+            Logger::write(LogLevel::Info, item.second ? LogCode::TakeProfit : LogCode::StopLoss,
+                          { profitRate }, 0, id, &m.getSymbols());
+
+            t.closeGapPosition(id, m);
+        }
+    }
+};
+
+// ============================================================
+// 팀원 C: DisruptedState 클래스
+// ============================================================
+class DisruptedState : public MarketState {
+private:
+    // 역발상 매수 대상 조건: 가격 하락률 < -15% & 거래량 비율 > 2.0 (200%)
+    static constexpr double FALL_THRESHOLD = -0.15;
+    static constexpr double VOLUME_RATIO_THRESHOLD = 2.0;
+
+    // 후보 버퍼 (매일 재사용)
+    ArenaVector<StockTable::Candidate> candidates;
+    ArenaVector<Stock*> selected;
+
+    // selected 중 아직 보유하지 않은 종목을 빈 슬롯만큼 매수. 투자금은 매수 전 현금 기준으로 균등 분배.
+    void buyTargets(Trader& t, Market& m, LogCode code) {
+        const auto& gapPositions = t.getGapPositions();
+        int targetCount = 0;
+
+        for (Stock* target : selected) {
+            if (!gapPositions.contains(target->getId())) ++targetCount;
+        }
+
+        int slots = t.getParams().maxPositions - t.getGapPositionCount();
+        targetCount = min(targetCount, slots);
+
+        double investAmount = calculateInvestAmount(t, targetCount);
+
+        if (investAmount < 1.0) return;
+
+        for (Stock* target : selected) {
+            if (t.getGapPositionCount() >= t.getParams().maxPositions) return;
+
+            // 이미 보유 중인지 확인
+            if (gapPositions.contains(target->getId())) continue;
+
+            double price = target->getCurrentPrice();
+            int qty = static_cast<int>(floor(investAmount / price));
+
+            if (qty <= 0) continue;
+
+            bool ok = t.buyGapPosition(target->getId(), qty, m);
+
+            if (ok) {
+                Logger::write(LogLevel::Info, code, { price, target->getFluctuationRate() },
+                              qty, target->getId(), &m.getSymbols());
+            }
+        }
+    }
+
+public:
+    explicit DisruptedState(Arena* arena = nullptr)
+        : candidates(ArenaAllocator<StockTable::Candidate>(arena)), selected(ArenaAllocator<Stock*>(arena)) {
+    }
+
+    void handle(Trader& t, Market& m) override {
+        // 특수 전략 실행: 후보는 전 종목을 한 번만 훑어 고른다
+        selectTargets(t, m);
+        executeContrarianBuy(t, m);
+        executeGapTrading(t, m);
+    }
+
+    string getStateName() const override { return "Disrupted"; }
+
+    StateId getStateId() const override { return StateId::Disrupted; }
+
+    // 빈 갭 포지션 슬롯 수만큼 (보유 종목 제외) 상위 후보를 selected에 채움 (execute*가 사용)
+    const ArenaVector<Stock*>& selectTargets(const Trader& t, Market& m) {
+        selected.clear();
+
+        int slots = t.getParams().maxPositions - t.getGapPositionCount();
+        if (slots <= 0) return selected;
+
+        // 보유 종목이 상위를 차지할 수 있으므로 그만큼 더 뽑은 뒤 제외
+        const auto& gapPositions = t.getGapPositions();
+        size_t k = static_cast<size_t>(slots) + gapPositions.size();
+        candidates.resize(k);
+
+        size_t found = m.getStockTable().selectFallers(FALL_THRESHOLD, VOLUME_RATIO_THRESHOLD, k, candidates.data());
+
+        for (size_t i = 0; i < found && selected.size() < static_cast<size_t>(slots); ++i) {
+            SymbolId id = static_cast<SymbolId>(candidates[i].index);
+            if (gapPositions.contains(id)) continue;
+
+            selected.push_back(m.getStockById(id));
+        }
+
+        return selected;
+    }
+
+    void executeGapTrading(Trader& t, Market& m) {
+        // 급락 주식 매수 (역발상 매수에서 사지 못한 후보)
+        buyTargets(t, m, LogCode::GapTradingBuy);
+    }
+
+    void executeContrarianBuy(Trader& t, Market& m) {
+        // 역발상 매수: 후보 전체에 투자금 분산
+        buyTargets(t, m, LogCode::ContrarianBuy);
+    }
+
+    Stock* selectBestTarget(Market& m) {
+        // 우선 순위: 하락률 (최대) -> 거래량 비율 (최대)
+        StockTable::Candidate best;
+
+        if (m.getStockTable().selectFallers(FALL_THRESHOLD, VOLUME_RATIO_THRESHOLD, 1, &best) == 0) return nullptr;
+
+        return m.getStockById(static_cast<SymbolId>(best.index));
+    }
+
+    double calculateInvestAmount(const Trader& t, int targets) {
+        if (targets <= 0) return 0.0;
+
+        double cash = t.getCash();
+
+        return (cash * t.getParams().investmentRatio) / static_cast<double>(targets);
+    }
+};
+
+// ============================================================
+// 팀원 C: DisruptionDetector 클래스
+// ============================================================
+class DisruptionDetector {
+    friend class SimulationSnapshot;    // 스냅샷 저장/복원
+
+public:
+    // 상태 체류 일수 히스토그램 구간 수 (마지막 구간 = 그 이상)
+    static constexpr size_t DWELL_BUCKETS = 32;
+
+    using DwellHistogram = array<uint64_t, DWELL_BUCKETS>;
+
+private:
+    // 상태 객체는 미리 만들어 두고 포인터만 바꿔 끼움 (전환 시 할당 없음)
+    NormalState normalState;
+    DisruptedState disruptedState;
+    MarketState* currentState;
+    StateId currentId;
+
+    double disruptionScore;
+    double threshold;           // 이 점수 초과 -> Disrupted
+    double recoveryThreshold;   // 이 점수 미만 -> Normal
+    double previousScore;
+    int transitionCount;    // 상태 전환 횟수
+
+    // 상태별 체류 기록: 현재 상태 연속 일수, 상태별 누적 일수, 끝난 체류 구간의 길이 분포
+    uint64_t currentDwell;
+    array<uint64_t, STATE_COUNT> daysInState;
+    array<DwellHistogram, STATE_COUNT> dwellHistogram;
+    uint64_t lastCountedDay;    // 체류 일수에 마지막으로 센 시장 일자 (0 = 아직 없음)
+
+    MarketState* stateFor(StateId id) {
+        if (id == StateId::Disrupted) return &disruptedState;
+
+        return &normalState;
+    }
+
+public:
+    explicit DisruptionDetector(const StrategyParams& params = StrategyParams(), Arena* arena = nullptr)
+        : normalState(arena), disruptedState(arena), currentState(nullptr), currentId(StateId::Normal), disruptionScore(0.0), threshold(params.threshold),
+          recoveryThreshold(params.recoveryThreshold), previousScore(0.0), transitionCount(0), currentDwell(0),
+          daysInState{}, dwellHistogram{}, lastCountedDay(0) {
+        // 초기 상태는 NormalState
+        currentState = stateFor(currentId);
+    }
+
+    // 상태 객체가 자기 자신(멤버)을 가리키므로 복사/이동 금지
+    DisruptionDetector(const DisruptionDetector&) = delete;
+    DisruptionDetector& operator=(const DisruptionDetector&) = delete;
+
+    void analyzeMarket(Market& m) {
+        PROFILE_SCOPE(Probe::AnalyzeMarket);
+
+        previousScore = disruptionScore;
+        disruptionScore = calculateScore(m);
+
+        // 상태 전환 로직
+        if (disruptionScore > threshold) {
+            // disruptionScore > 70 (기본값) -> DisruptedState로 전환
+            changeState(StateId::Disrupted);
+        }
+
+        else if (disruptionScore < recoveryThreshold) {
+            // disruptionScore < 50 (기본값) -> NormalState로 복귀
+            changeState(StateId::Normal);
+        }
+
+        else {
+            // recoveryThreshold <= disruptionScore <= threshold: 현재 상태 유지
+        }
+
+        // 체류 일수는 시장 일자마다 한 번만 센다 (장중 모드는 하루에 여러 번 분석).
+        // 장중 분석은 아직 전일 일자라 넘어가고, 장 마감 뒤 분석에서 (전환 후) 현재 상태로 보낸 하루로 센다.
+        if (m.getDay() != lastCountedDay) {
+            lastCountedDay = m.getDay();
+            ++currentDwell;
+            ++daysInState[static_cast<size_t>(currentId)];
+        }
+    }
+
+    static void logStateChange(const char* stateName) {
+        LogEvent ev;
+        ev.code = LogCode::StateChange;
+        ev.text = stateName;
+
+        Logger::write(LogLevel::Info, ev);
+    }
+
+    // 다른 상태로 전환: 끝난 체류 구간을 히스토그램에 기록하고 상태 포인터 교체
+    void changeState(StateId next) {
+        if (next == currentId) return;
+
+        if (currentDwell > 0) {
+            size_t bucket = static_cast<size_t>(min<uint64_t>(currentDwell, DWELL_BUCKETS - 1));
+            ++dwellHistogram[static_cast<size_t>(currentId)][bucket];
+        }
+
+        currentId = next;
+        currentState = stateFor(next);
+        currentDwell = 0;
+        ++transitionCount;
+
+        logStateChange(stateName(next));
+    }
+
+    void executeStrategy(Trader& t, Market& m) {
+        PROFILE_SCOPE(Probe::ExecuteStrategy);
+
+        if (currentState) {
+            currentState->handle(t, m);
+        }
+    }
+
+    double calculateScore(Market& m) const {
+        // 위험도 계산: disruptionScore = (현재 거래량 / 평균 거래량) x 변동성 x 1000
+        // 현재 거래량 / 평균 거래량은 최대 거래량 비율을 사용하여 가장 과도한 종목을 잡음
+        double maxVolRatio = m.getMaxVolumeRatio();
+        double volatility = m.getMarketVolatility();
+        double score = maxVolRatio * volatility * 1000.0;
+
+        return score;
+    }
+
+    bool checkRecovery() const {
+        return disruptionScore < recoveryThreshold;
+    }
+
+    double getDisruptionScore() const {
+        return disruptionScore;
+    }
+
+    bool isDisrupted() const {
+        return disruptionScore > threshold;
+    }
+
+    string getCurrentStateName() const {
+        return stateName(currentId);
+    }
+
+    StateId getCurrentStateId() const { return currentId; }
+
+    int getTransitionCount() const { return transitionCount; }
+
+    // 현재 상태로 연속해서 보낸 일수
+    uint64_t getCurrentDwell() const { return currentDwell; }
+
+    // 상태별 누적 일수
+    uint64_t getDaysInState(StateId id) const { return daysInState[static_cast<size_t>(id)]; }
+
+    // 끝난 체류 구간의 길이(일) 분포. 아직 진행 중인 구간은 포함하지 않음 (getCurrentDwell 참고).
+    const DwellHistogram& getDwellHistogram(StateId id) const { return dwellHistogram[static_cast<size_t>(id)]; }
+};
+
+// ============================================================
+// Trader::autoTrade() 구현 (DisruptionDetector 정의 후)
+// ============================================================
+void Trader::autoTrade(Market& m) {
+    PROFILE_SCOPE(Probe::AutoTrade);
+
+    if (!detector) return;
+
+    // 1) 시장 분석
+    detector->analyzeMarket(m);
+
+    // 로그
+    if (Logger::enabled(LogLevel::Info)) {
+        LogEvent ev;
+        ev.code = LogCode::AutoTradeStatus;
+        ev.text = stateName(detector->getCurrentStateId());
+        ev.values[0] = detector->getDisruptionScore();
+
+        Logger::write(LogLevel::Info, ev);
+    }
+
+    // 2) 현재 상태에 따른 전략 실행
+    detector->executeStrategy(*this, m);
+}
+
+int Trader::getStateTransitionCount() const {
+    return detector ? detector->getTransitionCount() : 0;
+}
+
+// ============================================================
+// 기본 시장 구성 (명세서의 5개 종목)
+// ============================================================
+void populateDefaultMarket(Market& market) {
+    market.addStock("삼성전자", 70000.0, 1000000.0);
+    market.addStock("SK하이닉스", 130000.0, 500000.0);
+    market.addStock("네이버", 200000.0, 300000.0);
+    market.addStock("카카오", 50000.0, 800000.0);
+    market.addStock("LG에너지솔루션", 400000.0, 200000.0);
+}
+
+// ============================================================
+// 공통: SimulationSnapshot (시뮬레이션 상태 저장/복원)
+// ============================================================
+// 하루 거래가 끝난 시점의 Market(종목 시세 열, 시장 집계, 시드/일자, 이동 구간 지표)과
+// Trader(현금, 포지션, 탐지기 상태)를 하나의 바이너리 파일로 저장한다. 파일 형식 (리틀 엔디언, 모든 구간 8바이트 경계):
+//   [Header 112바이트]
+//   [종목명: NUL 종료 문자열 stockCount개, 8바이트 경계까지 0으로 채움]
+//   [현재가 | 전일가 | 거래량 | 평균 거래량: 열마다 double x stockCount]
+//   [트레이더 traderCount개: TraderRecord + PositionRecord x (portfolioCount + gapCount) + 이름(패딩 포함)]
+//   [지표 (indicatorWindow > 0일 때만): 링 5개 x window x stockCount, 종목별 열 12개 x stockCount (double)]
+// 불러올 때는 파일을 읽기 전용으로 매핑하고 종목명 표만 한 번 만든다. 이후 복원(restoreMarket/restoreTrader)은
+// 매핑된 열을 그대로 복사하고 종목명 표는 공유하므로, 같은 스냅샷에서 수천 개의 분기를 싸게 만들 수 있다.
+// 지표는 restoreIndicators로 링 위치와 이동 합계까지 복원하므로 이어서 실행해도 끊지 않은 실행과 같은 값이 나온다.
+// 거래 내역(저널), 가격 이력, 주문장, 팩터 모델 상태는 저장하지 않는다 (주문장은 다음 날 첫 접근 때 다시 채워짐).
+class SimulationSnapshot {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t traderCount;
+        uint64_t stockCount;
+        uint64_t seed;
+        uint64_t day;
+        uint64_t namesBytes;        // 패딩 포함 종목명 구간 크기
+        uint64_t tradersBytes;      // 트레이더 구간 크기
+        uint64_t momentCount;       // 시장 집계 (StockTable::Moments): 누적 갱신값을 그대로 보존해 이어서 실행해도 같은 결과
+        double momentMean;
+        double momentM2;
+        double momentVolumeSum;
+        uint64_t indicatorWindow;   // 0이면 지표 구간 없음
+        uint64_t indicatorPos;      // RollingIndicators 링 위치 / 채워진 칸 수
+        uint64_t indicatorFilled;
+    };
+
+    struct TraderRecord {
+        double cash;
+        double realizedGapProfit;
+        double targetProfitRate;
+        double stopLossRate;
+        double investmentRatio;
+        double threshold;
+        double recoveryThreshold;
+        double disruptionScore;
+        double previousScore;
+        double portfolioValue;      // PositionBook 평가 금액/원가 누계
+        double portfolioCost;
+        double gapValue;
+        double gapCost;
+        uint64_t currentDwell;
+        uint64_t daysInState[STATE_COUNT];
+        uint64_t dwellHistogram[STATE_COUNT][DisruptionDetector::DWELL_BUCKETS];
+        int32_t maxPositions;
+        int32_t transitionCount;
+        uint32_t portfolioCount;
+        uint32_t gapCount;
+        uint32_t nameBytes;         // 패딩 포함 이름 크기
+        uint8_t stateId;
+        uint8_t reserved[3];
+    };
+
+    // 압축 배열 순서 그대로 저장 (청산 순서가 같도록)
+    struct PositionRecord {
+        int32_t symbol;
+        int32_t quantity;
+        double avgBuyPrice;
+        double mark;                // 평가 기준가
+        SimTime buyTimestamp;       // 가상 시각
+    };
+
+    static_assert(sizeof(Header) == 112, "스냅샷 헤더는 112바이트 고정");
+    static_assert(sizeof(TraderRecord) == 664, "트레이더 레코드는 664바이트 고정");
+    static_assert(sizeof(PositionRecord) == 32, "포지션 레코드는 32바이트 고정");
+
+    static constexpr char MAGIC[8] = { 'S', 'T', 'K', 'S', 'N', 'A', 'P', '\0' };
+    static constexpr uint32_t VERSION = 3;     // 2: 매수 시각을 가상 시각(나노초)으로, 3: 이동 구간 지표
+    static constexpr size_t COLUMNS = 4;
+    static constexpr size_t INDICATOR_RINGS = 5;
+    static constexpr size_t INDICATOR_COLUMNS = 12;
+
+private:
+    int fd;
+    const char* base;
+    size_t mappedBytes;
+    shared_ptr<SymbolTable> symbols;    // 복원한 시장들이 공유
+    vector<const TraderRecord*> traders;
+
+    const Header* header() const { return reinterpret_cast<const Header*>(base); }
+
+    const double* column(size_t c) const {
+        const Header* h = header();
+        return reinterpret_cast<const double*>(base + sizeof(Header) + h->namesBytes) + c * h->stockCount;
+    }
+
+    static const PositionRecord* positionsOf(const TraderRecord* rec) {
+        return reinterpret_cast<const PositionRecord*>(rec + 1);
+    }
+
+    // 지표 구간의 저장 순서: 링 (window칸, 칸마다 종목 순서) 다음에 종목별 열
+    using IndicatorColumn = vector<double> RollingIndicators::*;
+
+    static const IndicatorColumn* indicatorRings() {
+        static const IndicatorColumn rings[INDICATOR_RINGS] = {
+            &RollingIndicators::closeRing, &RollingIndicators::rateRing, &RollingIndicators::volumeRing,
+            &RollingIndicators::rangeRing, &RollingIndicators::suffixMax
+        };
+
+        return rings;
+    }
+
+    static const IndicatorColumn* indicatorColumns() {
+        static const IndicatorColumn columns[INDICATOR_COLUMNS] = {
+            &RollingIndicators::closeSum, &RollingIndicators::rateSum, &RollingIndicators::rateSquareSum,
+            &RollingIndicators::volumeSum, &RollingIndicators::volumeSquareSum, &RollingIndicators::rangeSum,
+            &RollingIndicators::prefixMax, &RollingIndicators::movingAverage, &RollingIndicators::volatility,
+            &RollingIndicators::drawdown, &RollingIndicators::averageRange, &RollingIndicators::volumeZ
+        };
+
+        return columns;
+    }
+
+    const double* indicatorData() const {
+        const Header* h = header();
+        return reinterpret_cast<const double*>(base + sizeof(Header) + h->namesBytes + COLUMNS * h->stockCount * sizeof(double) +
+                                               h->tradersBytes);
+    }
+
+    static size_t pad8(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+    // 트레이더 구간을 훑어 레코드 위치를 모으고 범위를 검사
+    bool indexTraders() {
+        const Header* h = header();
+        const char* cursor = base + sizeof(Header) + h->namesBytes + COLUMNS * h->stockCount * sizeof(double);
+        const char* end = cursor + h->tradersBytes;
+
+        for (uint32_t i = 0; i < h->traderCount; ++i) {
+            if (static_cast<size_t>(end - cursor) < sizeof(TraderRecord)) return false;
+
+            const TraderRecord* rec = reinterpret_cast<const TraderRecord*>(cursor);
+            size_t positions = static_cast<size_t>(rec->portfolioCount) + rec->gapCount;
+            size_t bytes = sizeof(TraderRecord) + positions * sizeof(PositionRecord) + rec->nameBytes;
+
+            if (rec->stateId >= STATE_COUNT || rec->nameBytes % 8 != 0 || static_cast<size_t>(end - cursor) < bytes) return false;
+
+            const PositionRecord* pos = positionsOf(rec);
+
+            for (size_t k = 0; k < positions; ++k) {
+                if (pos[k].symbol < 0 || static_cast<uint64_t>(pos[k].symbol) >= h->stockCount || pos[k].quantity <= 0) return false;
+            }
+
+            traders.push_back(rec);
+            cursor += bytes;
+        }
+
+        return true;
+    }
+
+    static void writePositions(ofstream& out, const PositionBook& book) {
+        for (size_t k = 0; k < book.size(); ++k) {
+            const Position& pos = book.at(k);
+            PositionRecord rec{ book.symbolAt(k), pos.quantity, pos.avgBuyPrice, book.marks[k], pos.buyTimestamp };
+
+            out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+        }
+    }
+
+    // 압축 배열 순서대로 다시 넣은 뒤 평가 누계는 저장된 값으로 덮어씀 (다음 평가 때 crossings 재구성)
+    static void restorePositions(PositionBook& book, const PositionRecord* recs, uint32_t count,
+                                 double value, double cost, Market& market) {
+        for (uint32_t k = 0; k < count; ++k) {
+            const PositionRecord& rec = recs[k];
+
+            book.add(rec.symbol, market.getStockById(rec.symbol), rec.quantity, rec.avgBuyPrice, rec.mark, rec.buyTimestamp);
+        }
+
+        book.value = value;
+        book.cost = cost;
+        book.crossingsStale = true;
+    }
+
+public:
+    SimulationSnapshot()
+        : fd(-1), base(nullptr), mappedBytes(0) {
+    }
+
+    ~SimulationSnapshot() {
+        close();
+    }
+
+    SimulationSnapshot(const SimulationSnapshot&) = delete;
+    SimulationSnapshot& operator=(const SimulationSnapshot&) = delete;
+
+    bool open(const string& path) {
+        close();
+
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close();
+            return false;
+        }
+
+        mappedBytes = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (p == MAP_FAILED) {
+            base = nullptr;
+            close();
+            return false;
+        }
+
+        base = static_cast<const char*>(p);
+
+        const Header* h = header();
+        size_t available = mappedBytes - sizeof(Header);
+
+        if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION || h->namesBytes % 8 != 0 ||
+            h->namesBytes > available || (available - h->namesBytes) / (COLUMNS * sizeof(double)) < h->stockCount ||
+            h->stockCount > static_cast<uint64_t>(numeric_limits<SymbolId>::max()) ||
+            available - h->namesBytes - COLUMNS * h->stockCount * sizeof(double) < h->tradersBytes ||
+            (h->stockCount > 0 && h->momentCount != h->stockCount)) {
+            close();
+            return false;
+        }
+
+        // 지표 구간: (링 5개 x window + 열 12개) x stockCount 개의 double이 남은 크기 안에 있어야 함
+        if (h->indicatorWindow > 0) {
+            size_t rest = (available - h->namesBytes - COLUMNS * h->stockCount * sizeof(double) - h->tradersBytes) / sizeof(double);
+            size_t perStock = h->stockCount > 0 ? rest / h->stockCount : 0;
+
+            if (h->indicatorPos >= h->indicatorWindow || h->indicatorFilled > h->indicatorWindow || h->stockCount == 0 ||
+                perStock < INDICATOR_COLUMNS || (perStock - INDICATOR_COLUMNS) / INDICATOR_RINGS < h->indicatorWindow) {
+                close();
+                return false;
+            }
+        }
+
+        // 종목명 (파일 순서 == SymbolId)
+        const char* cursor = base + sizeof(Header);
+        const char* namesEnd = cursor + h->namesBytes;
+        symbols = make_shared<SymbolTable>();
+        symbols->reserve(static_cast<size_t>(h->stockCount));
+
+        for (uint64_t i = 0; i < h->stockCount; ++i) {
+            const char* end = static_cast<const char*>(memchr(cursor, '\0', namesEnd - cursor));
+
+            if (!end || symbols->intern(string(cursor, end)) != static_cast<SymbolId>(i)) {
+                close();
+                return false;
+            }
+
+            cursor = end + 1;
+        }
+
+        if (!indexTraders()) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<char*>(base), mappedBytes);
+        if (fd >= 0) ::close(fd);
+
+        fd = -1;
+        base = nullptr;
+        mappedBytes = 0;
+        symbols.reset();
+        traders.clear();
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    size_t getStockCount() const { return base ? static_cast<size_t>(header()->stockCount) : 0; }
+
+    size_t getTraderCount() const { return traders.size(); }
+
+    uint64_t getSeed() const { return header()->seed; }
+
+    uint64_t getDay() const { return header()->day; }
+
+    // 빈 Market에 저장된 종목과 시세, 시장 집계, 시드/일자를 복원 (종목명 표는 스냅샷과 공유)
+    bool restoreMarket(Market& market) const {
+        if (!base || !market.getAllStocks().empty()) return false;
+
+        const Header* h = header();
+        const size_t n = static_cast<size_t>(h->stockCount);
+        StockTable& table = market.stockTable;
+
+        table.symbols = symbols;
+        table.currentPrice.assign(column(0), column(0) + n);
+        table.previousPrice.assign(column(1), column(1) + n);
+        table.volume.assign(column(2), column(2) + n);
+        table.averageVolume.assign(column(3), column(3) + n);
+        table.growTree();
+        table.totals = StockTable::Moments{ static_cast<size_t>(h->momentCount), h->momentMean, h->momentM2, h->momentVolumeSum };
+        ++table.priceVersion;
+
+        static_assert(is_trivially_destructible<Stock>::value, "Arena의 종목 뷰는 소멸자를 부르지 않음");
+
+        Arena* views = market.arena ? market.arena : &market.stockArena;
+        market.allStocks.reserve(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            market.allStocks.push_back(views->create<Stock>(&table, i));
+        }
+
+        market.seed = h->seed;
+        market.day = h->day;
+        market.clock->reset(SimClock::at(h->day, SimClock::SESSION_CLOSE));
+
+        return true;
+    }
+
+    // 저장된 이동 구간 지표를 restoreMarket으로 복원한 market에 켠다. 지표가 저장되지 않았거나 구간 일수가 다르면 false
+    bool restoreIndicators(Market& market, size_t window) const {
+        const Header* h = header();
+
+        if (!base || h->indicatorWindow == 0 || h->indicatorWindow != window || market.stockTable.size() != h->stockCount) {
+            return false;
+        }
+
+        const size_t n = static_cast<size_t>(h->stockCount);
+        const double* cursor = indicatorData();
+        unique_ptr<RollingIndicators> indicators = make_unique<RollingIndicators>(window);
+
+        indicators->pos = static_cast<size_t>(h->indicatorPos);
+        indicators->filled = static_cast<size_t>(h->indicatorFilled);
+        indicators->count = n;
+        indicators->stride = n;
+
+        for (size_t r = 0; r < INDICATOR_RINGS; ++r) {
+            (*indicators.*indicatorRings()[r]).assign(cursor, cursor + window * n);
+            cursor += window * n;
+        }
+
+        for (size_t c = 0; c < INDICATOR_COLUMNS; ++c) {
+            (*indicators.*indicatorColumns()[c]).assign(cursor, cursor + n);
+            cursor += n;
+        }
+
+        market.indicators = move(indicators);
+
+        return true;
+    }
+
+    // i번째 트레이더를 restoreMarket으로 복원한 market 위에 다시 만든다 (arena를 넘기면 그 안에)
+    ArenaPtr<Trader> restoreTrader(size_t i, Market& market, Arena* arena = nullptr) const {
+        const TraderRecord& rec = *traders[i];
+        const PositionRecord* positions = positionsOf(&rec);
+        const char* name = reinterpret_cast<const char*>(positions + rec.portfolioCount + rec.gapCount);
+
+        StrategyParams params;
+        params.targetProfitRate = rec.targetProfitRate;
+        params.stopLossRate = rec.stopLossRate;
+        params.investmentRatio = rec.investmentRatio;
+        params.maxPositions = rec.maxPositions;
+        params.threshold = rec.threshold;
+        params.recoveryThreshold = rec.recoveryThreshold;
+
+        ArenaPtr<Trader> trader = makeArenaPtr<Trader>(arena, string(name, strnlen(name, rec.nameBytes)), rec.cash, params, arena);
+        trader->realizedGapProfit = rec.realizedGapProfit;
+
+        restorePositions(trader->portfolio, positions, rec.portfolioCount, rec.portfolioValue, rec.portfolioCost, market);
+        restorePositions(trader->gapPositions, positions + rec.portfolioCount, rec.gapCount, rec.gapValue, rec.gapCost, market);
+
+        DisruptionDetector& d = *trader->detector;
+        d.currentId = static_cast<StateId>(rec.stateId);
+        d.currentState = d.stateFor(d.currentId);
+        d.disruptionScore = rec.disruptionScore;
+        d.previousScore = rec.previousScore;
+        d.transitionCount = rec.transitionCount;
+        d.currentDwell = rec.currentDwell;
+        d.lastCountedDay = market.getDay();     // 스냅샷은 그날 매매를 마친 뒤 저장하므로 이미 센 일자
+
+        for (size_t s = 0; s < STATE_COUNT; ++s) {
+            d.daysInState[s] = rec.daysInState[s];
+            copy(rec.dwellHistogram[s], rec.dwellHistogram[s] + DisruptionDetector::DWELL_BUCKETS, d.dwellHistogram[s].begin());
+        }
+
+        return trader;
+    }
+
+    static bool write(const string& path, const Market& market, const vector<const Trader*>& traderList) {
+        const StockTable& table = market.stockTable;
+        const size_t n = table.size();
+
+        string namesBlock;
+        for (size_t i = 0; i < n; ++i) {
+            namesBlock += table.getName(i);
+            namesBlock += '\0';
+        }
+        namesBlock.resize(pad8(namesBlock.size()), '\0');
+
+        Header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.traderCount = static_cast<uint32_t>(traderList.size());
+        h.stockCount = n;
+        h.seed = market.seed;
+        h.day = market.day;
+        h.namesBytes = namesBlock.size();
+        h.momentCount = table.totals.count;
+        h.momentMean = table.totals.mean;
+        h.momentM2 = table.totals.m2;
+        h.momentVolumeSum = table.totals.volumeSum;
+
+        const RollingIndicators* indicators = market.indicators.get();
+
+        if (indicators && n > 0) {
+            h.indicatorWindow = indicators->window;
+            h.indicatorPos = indicators->pos;
+            h.indicatorFilled = indicators->filled;
+        }
+
+        for (const Trader* t : traderList) {
+            h.tradersBytes += sizeof(TraderRecord) + (t->portfolio.size() + t->gapPositions.size()) * sizeof(PositionRecord) +
+                              pad8(t->username.size() + 1);
+        }
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(namesBlock.data(), namesBlock.size());
+
+        const ArenaVector<double>* columns[COLUMNS] = { &table.currentPrice, &table.previousPrice, &table.volume, &table.averageVolume };
+        for (const ArenaVector<double>* col : columns) {
+            out.write(reinterpret_cast<const char*>(col->data()), n * sizeof(double));
+        }
+
+        for (const Trader* t : traderList) {
+            const DisruptionDetector& d = *t->detector;
+            const StrategyParams& params = t->params;
+
+            TraderRecord rec;
+            memset(&rec, 0, sizeof(rec));
+            rec.cash = t->cash;
+            rec.realizedGapProfit = t->realizedGapProfit;
+            rec.targetProfitRate = params.targetProfitRate;
+            rec.stopLossRate = params.stopLossRate;
+            rec.investmentRatio = params.investmentRatio;
+            rec.threshold = params.threshold;
+            rec.recoveryThreshold = params.recoveryThreshold;
+            rec.maxPositions = params.maxPositions;
+            rec.disruptionScore = d.disruptionScore;
+            rec.previousScore = d.previousScore;
+            rec.portfolioValue = t->portfolio.value;
+            rec.portfolioCost = t->portfolio.cost;
+            rec.gapValue = t->gapPositions.value;
+            rec.gapCost = t->gapPositions.cost;
+            rec.currentDwell = d.currentDwell;
+            rec.transitionCount = d.transitionCount;
+            rec.stateId = static_cast<uint8_t>(d.currentId);
+            rec.portfolioCount = static_cast<uint32_t>(t->portfolio.size());
+            rec.gapCount = static_cast<uint32_t>(t->gapPositions.size());
+            rec.nameBytes = static_cast<uint32_t>(pad8(t->username.size() + 1));
+
+            for (size_t s = 0; s < STATE_COUNT; ++s) {
+                rec.daysInState[s] = d.daysInState[s];
+                copy(d.dwellHistogram[s].begin(), d.dwellHistogram[s].end(), rec.dwellHistogram[s]);
+            }
+
+            out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            writePositions(out, t->portfolio);
+            writePositions(out, t->gapPositions);
+
+            string name = t->username;
+            name.resize(rec.nameBytes, '\0');
+            out.write(name.data(), name.size());
+        }
+
+        // 지표: 링은 stride 간격의 칸에서 앞 n종목만 (n < stride일 수 있음)
+        if (h.indicatorWindow > 0) {
+            for (size_t r = 0; r < INDICATOR_RINGS; ++r) {
+                const vector<double>& ring = indicators->*indicatorRings()[r];
+
+                for (size_t s = 0; s < indicators->window; ++s) {
+                    out.write(reinterpret_cast<const char*>(ring.data() + s * indicators->stride), n * sizeof(double));
+                }
+            }
+
+            for (size_t c = 0; c < INDICATOR_COLUMNS; ++c) {
+                out.write(reinterpret_cast<const char*>((indicators->*indicatorColumns()[c]).data()), n * sizeof(double));
+            }
+        }
+
+        return static_cast<bool>(out);
+    }
+};
+
+// ============================================================
+// 공통: IntradaySimulator (이벤트 기반 장중 틱 시뮬레이션)
+// ============================================================
+// 하루(09:00 ~ 15:30)를 WHEEL_SLOTS칸 타이머 휠로 나누고, 종목마다 다음 틱 시각을 지수 분포 간격으로 예약한다.
+// 종목당 대기 이벤트는 하나뿐이므로 칸별 목록은 종목 배열을 잇는 단일 연결 리스트 (예약/처리 시 할당 없음).
+// 각 틱은 당일 종가(일괄 시뮬레이션과 같은 Philox 난수)를 향하는 경로 위의 가격과 누적 거래량을 만든다.
+//  - 정상일: 시가 -> 종가 사이 브라운 브리지형 경로, 거래량은 시간에 비례
+//  - 블랙스완: 장중 임의 시각에 급락, 그 뒤로 거래량 급증
+// 전략(Trader::autoTrade)은 다음 사건이 생긴 틱에서만 다시 실행한다.
+//  - 위험도 점수가 전환/복귀 기준을 넘나듦
+//  - 보유 갭 포지션이 목표 수익률/손절 기준을 넘음
+//  - Disrupted 상태에서 새 급락 후보가 생김
+// 장 마감 때 모든 종목을 종가로 맞추므로 일별 종가·거래량·집계는 simulateFluctuation()과 같다.
+class IntradaySimulator {
+public:
+    static constexpr uint32_t WHEEL_SLOTS = 1024;
+    static constexpr int SESSION_OPEN_MINUTE = 9 * 60;
+    static constexpr int SESSION_MINUTES = 390;
+
+    struct Stats {
+        uint64_t events = 0;            // 처리한 틱 수
+        uint64_t strategyRuns = 0;      // 사건으로 전략을 다시 실행한 횟수
+    };
+
+private:
+    static constexpr uint64_t INTRADAY_STREAM = 0x1D7A;
+    static constexpr double INTRADAY_NOISE = 0.01;     // 장중 가격 잡음 (시가 대비 표준편차, 장 중간 기준)
+
+    Market& market;
+    double meanGap;                 // 종목별 평균 틱 간격 (칸)
+
+    // 타이머 휠: 칸별 첫 종목, 종목별 다음 종목 (-1 = 끝)
+    array<int32_t, WHEEL_SLOTS> slotHead;
+    vector<int32_t> nextInSlot;
+
+    // 종목별 당일 경로 (장 시작 시 계산)
+    vector<double> openPrice;
+    vector<double> closePrice;
+    vector<double> dayVolume;
+    vector<double> baseAverage;     // 전일까지의 평균 거래량
+    vector<double> shockTime;       // 블랙스완 시각 (0 ~ 1), 정상일은 2.0
+    vector<uint32_t> tickCount;
+    vector<double> factorRate;      // 요인 모형 사용 시 종목별 당일 변동률/거래량 배수
+    vector<double> factorVolume;
+
+    // 사건 감지 상태
+    vector<double> watchBuyPrice;   // 보유 갭 포지션 평균 단가 (미보유 0)
+    vector<SymbolId> watched;
+    vector<uint8_t> candidate;      // 급락 후보 조건을 이미 만족했는지
+    int scoreBand;                  // 0: 복귀 기준 미만, 1: 사이, 2: 전환 기준 초과
+
+    // 틱마다 호출 (가격/거래량 반영 직후, 코루틴 전략 실행기 연결용). 비어 있으면 호출 안 함
+    function<void(SymbolId)> tickHook;
+
+    Stats stats;
+
+    void schedule(int32_t stock, uint32_t slot) {
+        nextInSlot[stock] = slotHead[slot];
+        slotHead[slot] = stock;
+    }
+
+    // 지수 분포 간격 (최소 1칸)
+    uint32_t nextGap(double u) const {
+        return 1 + static_cast<uint32_t>(-log1p(-u) * meanGap);
+    }
+
+    int bandOf(double score, const StrategyParams& params) const {
+        return score > params.threshold ? 2 : (score < params.recoveryThreshold ? 0 : 1);
+    }
+
+    void refreshWatch(const Trader* trader) {
+        for (SymbolId id : watched) watchBuyPrice[id] = 0.0;
+        watched.clear();
+
+        if (!trader) return;
+
+        const PositionBook& gapPositions = trader->getGapPositions();
+
+        for (size_t k = 0; k < gapPositions.size(); ++k) {
+            watchBuyPrice[gapPositions.symbolAt(k)] = gapPositions.at(k).avgBuyPrice;
+            watched.push_back(gapPositions.symbolAt(k));
+        }
+    }
+
+    void beginDay() {
+        const StockTable& table = market.getStockTable();
+        size_t n = table.size();
+        uint64_t seed = market.getSeed();
+        uint64_t day = market.getDay();
+
+        market.beginIntradayDay();
+
+        // 요인 모형이면 일별 변동을 한꺼번에 만들고, 급락은 모든 종목이 같은 시각에 맞음
+        const FactorModel* factors = market.getFactorModel();
+        FactorModel::Day factorDay{};
+
+        if (factors) {
+            factorDay = factors->drawDay(seed, day);
+            factors->generate(factorDay, 0, n, seed, day, factorRate.data(), factorVolume.data());
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            // 종가/거래량은 simulateFluctuation()과 같은 난수·공식
+            Philox4x32::Counter r = Philox4x32::generate(seed, day, i);
+            bool blackSwan = factors ? factorDay.jump : Philox4x32::toUnit(r[0]) >= 0.95;
+            double changeRate = factors ? factorRate[i]
+                                        : (blackSwan ? Philox4x32::toUnit(r[1]) * (-0.20) - 0.10
+                                                     : Philox4x32::toUnit(r[1]) * 0.04 - 0.02);
+            double volumeMultiplier = factors ? factorVolume[i]
+                                              : (blackSwan ? 2.0 + Philox4x32::toUnit(r[2]) * 2.0
+                                                           : 0.8 + Philox4x32::toUnit(r[2]) * 0.4);
+
+            double open = table.getCurrentPrice(i);
+            double close = open * (1.0 + changeRate);
+
+            openPrice[i] = open;
+            closePrice[i] = close < 0.01 ? 0.01 : close;
+            baseAverage[i] = table.getAverageVolume(i);
+            dayVolume[i] = baseAverage[i] * volumeMultiplier;
+            shockTime[i] = !blackSwan ? 2.0 : (factors ? factorDay.jumpTime : 0.1 + Philox4x32::toUnit(r[3]) * 0.8);
+            tickCount[i] = 0;
+            candidate[i] = 0;
+
+            market.setIntradayVolume(static_cast<SymbolId>(i), 0.0, baseAverage[i]);
+        }
+
+        slotHead.fill(-1);
+        uint64_t stream = mixSeed(seed, INTRADAY_STREAM);
+
+        for (size_t i = 0; i < n; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(stream, day, i << 20);
+            uint32_t first = nextGap(Philox4x32::toUnit(r[0])) - 1;
+
+            if (first < WHEEL_SLOTS) schedule(static_cast<int32_t>(i), first);
+        }
+    }
+
+    // 종목 i의 t시점 틱: 가격/누적 거래량 반영, 다음 틱 예약용 난수 반환
+    double tick(size_t i, double t, uint64_t stream, uint64_t day) {
+        Philox4x32::Counter r = Philox4x32::generate(stream, day, (static_cast<uint64_t>(i) << 20) | ++tickCount[i]);
+
+        // 평균 0, 분산 1 균등 잡음 x 브리지 폭 (시가/종가에서 0)
+        double noise = (Philox4x32::toUnit(r[0]) * 2.0 - 1.0) * 1.7320508075688772 * INTRADAY_NOISE * sqrt(t * (1.0 - t));
+        double shock = shockTime[i];
+        double price;
+        double volumeSoFar;
+
+        if (t < shock) {
+            // 정상일 또는 급락 전: 시가 -> (정상일) 종가로 선형 이동 + 잡음
+            double target = shock > 1.0 ? closePrice[i] : openPrice[i];
+            price = openPrice[i] + (target - openPrice[i]) * t + openPrice[i] * noise;
+            volumeSoFar = shock > 1.0 ? dayVolume[i] * t : baseAverage[i] * t;
+        }
+
+        else {
+            // 급락 후: 종가 수준 + 잡음, 남은 거래량이 마감까지 몰림
+            price = closePrice[i] * (1.0 + noise);
+            double before = baseAverage[i] * shock;
+            volumeSoFar = before + (dayVolume[i] - before) * (t - shock) / (1.0 - shock);
+        }
+
+        SymbolId id = static_cast<SymbolId>(i);
+        market.setIntradayPrice(id, price < 0.01 ? 0.01 : price);
+        market.setIntradayVolume(id, volumeSoFar, baseAverage[i]);
+
+        return Philox4x32::toUnit(r[1]);
+    }
+
+    // 틱이 전략 재실행 사건인지 판단
+    bool isRelevant(size_t i, const Trader& trader) {
+        const StrategyParams& params = trader.getParams();
+        const StockTable& table = market.getStockTable();
+
+        int band = bandOf(market.getMaxVolumeRatio() * market.getMarketVolatility() * 1000.0, params);
+        bool relevant = band != scoreBand;
+        scoreBand = band;
+
+        double buyPrice = watchBuyPrice[i];
+
+        if (buyPrice > 0.0) {
+            double profitRate = (table.getCurrentPrice(i) - buyPrice) / buyPrice;
+            relevant |= profitRate >= params.targetProfitRate || profitRate <= params.stopLossRate;
+        }
+
+        if (!candidate[i] && trader.getDetector().getCurrentStateId() == StateId::Disrupted) {
+            bool qualifies = StockTable::fluctuationRate(table.getCurrentPrice(i), table.getPreviousPrice(i)) < -0.15 &&
+                             StockTable::volumeRatio(table.getVolume(i), table.getAverageVolume(i)) > 2.0;
+            candidate[i] = qualifies;
+            relevant |= qualifies;
+        }
+
+        return relevant;
+    }
+
+public:
+    IntradaySimulator(Market& market, uint32_t ticksPerStock)
+        : market(market), meanGap(static_cast<double>(WHEEL_SLOTS) / max<uint32_t>(1, ticksPerStock)), scoreBand(0) {
+    }
+
+    // 하루 장중 시뮬레이션 후 장 마감 (Market 일자 + 1). trader가 있으면 사건마다 autoTrade 실행.
+    void runDay(Trader* trader) {
+        size_t n = market.getStockTable().size();
+
+        nextInSlot.resize(n);
+        openPrice.resize(n);
+        closePrice.resize(n);
+        dayVolume.resize(n);
+        baseAverage.resize(n);
+        shockTime.resize(n);
+        tickCount.resize(n);
+        candidate.resize(n);
+        factorRate.resize(n);
+        factorVolume.resize(n);
+        watchBuyPrice.resize(n, 0.0);
+
+        beginDay();
+        refreshWatch(trader);
+
+        uint64_t stream = mixSeed(market.getSeed(), INTRADAY_STREAM);
+        uint64_t day = market.getDay();
+
+        if (trader) {
+            scoreBand = bandOf(market.getMaxVolumeRatio() * market.getMarketVolatility() * 1000.0, trader->getParams());
+        }
+
+        for (uint32_t slot = 0; slot < WHEEL_SLOTS; ++slot) {
+            double t = (slot + 0.5) / WHEEL_SLOTS;
+            market.advanceClock(SimClock::sessionTime(day + 1, t));
+
+            // 같은 칸의 틱은 모두 처리한 뒤 사건이 있었으면 전략을 한 번 실행
+            int32_t stock = slotHead[slot];
+            slotHead[slot] = -1;
+            SymbolId trigger = INVALID_SYMBOL;
+
+            while (stock >= 0) {
+                int32_t following = nextInSlot[stock];
+                double u = tick(static_cast<size_t>(stock), t, stream, day);
+                ++stats.events;
+
+                if (tickHook) tickHook(static_cast<SymbolId>(stock));
+
+                if (trader && isRelevant(static_cast<size_t>(stock), *trader)) trigger = stock;
+
+                uint32_t next = slot + nextGap(u);
+                if (next < WHEEL_SLOTS) schedule(stock, next);
+
+                stock = following;
+            }
+
+            if (trigger != INVALID_SYMBOL) {
+                ++stats.strategyRuns;
+
+                if (Logger::enabled(LogLevel::Info)) {
+                    int minute = SESSION_OPEN_MINUTE + static_cast<int>(t * SESSION_MINUTES);
+                    Logger::write(LogLevel::Info, LogCode::IntradayTrigger, {}, minute, trigger, &market.getSymbols());
+                }
+
+                trader->autoTrade(market);
+                refreshWatch(trader);
+            }
+        }
+
+        // 장 마감: 종가/당일 거래량 확정
+        for (size_t i = 0; i < n; ++i) {
+            market.setIntradayPrice(static_cast<SymbolId>(i), closePrice[i]);
+            market.setIntradayVolume(static_cast<SymbolId>(i), dayVolume[i], baseAverage[i]);
+        }
+
+        market.endIntradayDay();
+    }
+
+    void setTickHook(function<void(SymbolId)> hook) { tickHook = move(hook); }
+
+    const Stats& getStats() const { return stats; }
+};
+
+// ============================================================
+// 공통: Histogram (고정 구간 히스토그램)
+// ============================================================
+class Histogram {
+private:
+    string title;
+    double lo;
+    double hi;
+    vector<uint64_t> bins;
+    uint64_t underflow;
+    uint64_t overflow;
+    uint64_t count;
+    double sum;
+    double minValue;
+    double maxValue;
+
+public:
+    Histogram(const string& title, double lo, double hi, size_t binCount)
+        : title(title), lo(lo), hi(hi), bins(binCount, 0), underflow(0), overflow(0),
+          count(0), sum(0.0), minValue(0.0), maxValue(0.0) {
+    }
+
+    void add(double v) {
+        if (count == 0 || v < minValue) minValue = v;
+        if (count == 0 || v > maxValue) maxValue = v;
+
+        ++count;
+        sum += v;
+
+        if (v < lo) {
+            ++underflow;
+        }
+
+        else if (v >= hi) {
+            ++overflow;
+        }
+
+        else {
+            size_t b = static_cast<size_t>((v - lo) / (hi - lo) * bins.size());
+            ++bins[min(b, bins.size() - 1)];
+        }
+    }
+
+    // 같은 구간 설정의 히스토그램 병합
+    void merge(const Histogram& other) {
+        if (other.count == 0) return;
+
+        if (count == 0 || other.minValue < minValue) minValue = other.minValue;
+        if (count == 0 || other.maxValue > maxValue) maxValue = other.maxValue;
+
+        for (size_t b = 0; b < bins.size(); ++b) bins[b] += other.bins[b];
+
+        underflow += other.underflow;
+        overflow += other.overflow;
+        count += other.count;
+        sum += other.sum;
+    }
+
+    uint64_t getCount() const { return count; }
+
+    double getMean() const { return count ? sum / count : 0.0; }
+
+    // 구간 내 선형 보간으로 근사한 분위수 (q: 0.0 ~ 1.0)
+    double quantile(double q) const {
+        if (count == 0) return 0.0;
+
+        double target = q * count;
+        double seen = static_cast<double>(underflow);
+
+        if (target <= seen) return minValue;
+
+        double width = (hi - lo) / bins.size();
+
+        for (size_t b = 0; b < bins.size(); ++b) {
+            if (seen + bins[b] >= target && bins[b] > 0) {
+                return lo + width * (b + (target - seen) / bins[b]);
+            }
+
+            seen += bins[b];
+        }
+
+        return maxValue;
+    }
+
+    void print() const {
+        cout << "\n[" << title << "]" << endl;
+        cout << "  표본: " << count
+             << " | 평균: " << fixed << setprecision(4) << getMean()
+             << " | 최소: " << minValue << " | 최대: " << maxValue << endl;
+        cout << "  P5: " << quantile(0.05) << " | P50: " << quantile(0.50)
+             << " | P95: " << quantile(0.95) << endl;
+
+        uint64_t peak = 1;
+        for (uint64_t c : bins) peak = max(peak, c);
+
+        const int BAR_WIDTH = 40;
+        double width = (hi - lo) / bins.size();
+
+        if (underflow) cout << "  " << setw(14) << "< " << lo << " | " << underflow << endl;
+
+        for (size_t b = 0; b < bins.size(); ++b) {
+            if (bins[b] == 0) continue;
+
+            int bar = static_cast<int>(static_cast<double>(bins[b]) / peak * BAR_WIDTH);
+
+            cout << "  " << setw(14) << fixed << setprecision(4) << (lo + width * b)
+                 << " | " << string(max(bar, 1), '#') << " " << bins[b] << endl;
+        }
+
+        if (overflow) cout << "  " << setw(14) << ">= " << hi << " | " << overflow << endl;
+    }
+};
+
+// ============================================================
+// 공통: MonteCarloRunner (독립 경로 배치 시뮬레이션)
+// ============================================================
+// 경로마다 Market + Trader(+DisruptionDetector)를 새로 만들어 출력 없이 days일 자동매매를 돌리고,
+// 최종 자산, 최대 낙폭, 상태 전환 횟수, 갭 트레이딩 손익을 히스토그램으로 집계한다.
+// 경로 블록 단위로 작업 훔치기 풀에 분배하며, 블록 결과는 블록 순서대로 병합하여 재현 가능하다.
+class MonteCarloRunner {
+public:
+    struct Config {
+        uint64_t paths = 100000;
+        int days = 10;
+        uint64_t seed = 0;
+        double initialCash = 10000000.0;
+        const FactorModel::Config* factorModel = nullptr;   // nullptr이면 종목별 독립 변동
+    };
+
+    struct Result {
+        Histogram finalAsset;
+        Histogram drawdown;
+        Histogram transitions;
+        Histogram gapProfit;
+        Histogram disruptedDwell;
+
+        explicit Result(const Config& cfg)
+            : finalAsset("최종 자산 (초기 대비 배수)", 0.0, 2.0, 40),
+              drawdown("최대 낙폭", 0.0, 1.0, 40),
+              transitions("상태 전환 횟수", 0.0, cfg.days + 1.0, cfg.days + 1),
+              gapProfit("갭 트레이딩 손익 (초기 자본 대비)", -0.5, 0.5, 40),
+              disruptedDwell("Disrupted 체류 일수 (구간별)", 1.0, DisruptionDetector::DWELL_BUCKETS,
+                             DisruptionDetector::DWELL_BUCKETS - 1) {
+        }
+
+        void merge(const Result& other) {
+            finalAsset.merge(other.finalAsset);
+            drawdown.merge(other.drawdown);
+            transitions.merge(other.transitions);
+            gapProfit.merge(other.gapProfit);
+            disruptedDwell.merge(other.disruptedDwell);
+        }
+    };
+
+private:
+    static constexpr uint64_t PATHS_PER_TASK = 256;
+
+    Config config;
+
+    // 경로의 Market/Trader 데이터는 arena에 두고, 함수가 끝나 객체가 소멸한 뒤 호출자가 reset
+    void runPath(uint64_t path, Result& out, Arena& arena) const {
+        Market market(mixSeed(config.seed, path), &arena);
+        populateDefaultMarket(market);
+
+        if (config.factorModel) market.enableFactorModel(*config.factorModel);
+
+        Trader trader("MonteCarlo", config.initialCash, StrategyParams(), &arena);
+
+        double peak = config.initialCash;
+        double maxDrawdown = 0.0;
+
+        for (int day = 1; day <= config.days; ++day) {
+            market.simulateFluctuation();
+            trader.autoTrade(market);
+
+            double asset = trader.getTotalAssetValue(market);
+            peak = max(peak, asset);
+            maxDrawdown = max(maxDrawdown, (peak - asset) / peak);
+        }
+
+        out.finalAsset.add(trader.getTotalAssetValue(market) / config.initialCash);
+        out.drawdown.add(maxDrawdown);
+        out.transitions.add(trader.getStateTransitionCount());
+        out.gapProfit.add(trader.getGapTradeProfit(market) / config.initialCash);
+
+        // 끝난 Disrupted 체류 구간 + 마지막 날까지 이어진 구간
+        const DisruptionDetector& detector = trader.getDetector();
+        const DisruptionDetector::DwellHistogram& dwell = detector.getDwellHistogram(StateId::Disrupted);
+
+        for (size_t days = 1; days < dwell.size(); ++days) {
+            for (uint64_t n = 0; n < dwell[days]; ++n) out.disruptedDwell.add(static_cast<double>(days));
+        }
+
+        if (detector.getCurrentStateId() == StateId::Disrupted) {
+            out.disruptedDwell.add(static_cast<double>(min<uint64_t>(detector.getCurrentDwell(), dwell.size() - 1)));
+        }
+    }
+
+public:
+    explicit MonteCarloRunner(const Config& config)
+        : config(config) {
+    }
+
+    Result run(ThreadPool& pool) const {
+        size_t tasks = static_cast<size_t>((config.paths + PATHS_PER_TASK - 1) / PATHS_PER_TASK);
+        vector<Result> partial(tasks, Result(config));
+
+        pool.parallelFor(tasks, [&](size_t task) {
+            uint64_t begin = task * PATHS_PER_TASK;
+            uint64_t end = min<uint64_t>(config.paths, begin + PATHS_PER_TASK);
+
+            // 작업별 Arena: 경로마다 O(1) reset, 청크는 첫 경로에서 한 번만 확보
+            Arena arena;
+
+            for (uint64_t path = begin; path < end; ++path) {
+                runPath(path, partial[task], arena);
+                arena.reset();
+            }
+        });
+
+        Result total(config);
+
+        for (const Result& r : partial) {
+            total.merge(r);
+        }
+
+        return total;
+    }
+};
+
+// ============================================================
+// 공통: ParameterSweep (전략 매개변수 병렬 탐색)
+// ============================================================
+// 시장 경로를 한 번만 만들어 읽기 전용으로 공유하고, 매개변수 조합마다 Market + Trader를 새로 만들어
+// 그 경로를 재생(Market::replayDay)하며 자동매매를 평가한다. 조합 블록 단위로 작업 훔치기 풀에 분배하고,
+// 결과는 조합 순서대로 기록한 뒤 최종 자산(높은 순) -> 최대 낙폭(낮은 순)으로 정렬한다.
+class ParameterSweep {
+public:
+    // 공유 시장 경로: 0일차 = 초기 시세, bars[day * stockCount + stock]
+    struct MarketPath {
+        vector<string> names;
+        vector<MarketBar> storage;      // 생성한 경로 (파일 재생이면 비어 있음)
+        const MarketBar* bars = nullptr;
+        size_t stockCount = 0;
+        size_t dayCount = 0;
+
+        const MarketBar* row(size_t day) const { return bars + day * stockCount; }
+    };
+
+    struct Result {
+        size_t index;               // 조합 번호 (생성 순서)
+        StrategyParams params;
+        double finalAsset;          // 초기 자본 대비 배수
+        double maxDrawdown;
+        int transitions;
+    };
+
+private:
+    static constexpr size_t SETS_PER_TASK = 64;
+
+    const MarketPath& path;
+    double initialCash;
+
+    Result evaluate(size_t index, const StrategyParams& params, Arena* arena = nullptr) const {
+        Market market(0, arena);
+
+        for (size_t s = 0; s < path.stockCount; ++s) {
+            market.addStock(path.names[s], path.row(0)[s].price, path.row(0)[s].volume);
+        }
+
+        Trader trader("Sweep", initialCash, params, arena);
+
+        double peak = initialCash;
+        double maxDrawdown = 0.0;
+
+        for (size_t day = 1; day < path.dayCount; ++day) {
+            market.replayDay(path.row(day));
+            trader.autoTrade(market);
+
+            double asset = trader.getTotalAssetValue(market);
+            peak = max(peak, asset);
+            maxDrawdown = max(maxDrawdown, (peak - asset) / peak);
+        }
+
+        return Result{ index, params, trader.getTotalAssetValue(market) / initialCash, maxDrawdown,
+                       trader.getStateTransitionCount() };
+    }
+
+public:
+    ParameterSweep(const MarketPath& path, double initialCash)
+        : path(path), initialCash(initialCash) {
+    }
+
+    // 기본 시장을 days일 시뮬레이션한 경로 (시드 고정 -> 재현 가능)
+    // factors가 있으면 상관 요인 모형으로 생성
+    static MarketPath generatePath(uint64_t seed, int days, ThreadPool* pool, const FactorModel::Config* factors = nullptr) {
+        Market market(seed);
+        market.setThreadPool(pool);
+        populateDefaultMarket(market);
+
+        if (factors) market.enableFactorModel(*factors);
+
+        MarketPath out;
+        out.stockCount = market.getAllStocks().size();
+        out.dayCount = static_cast<size_t>(days) + 1;
+        out.storage.resize(out.dayCount * out.stockCount);
+
+        for (size_t s = 0; s < out.stockCount; ++s) {
+            out.names.push_back(market.getStockTable().getName(s));
+        }
+
+        for (size_t day = 0; day < out.dayCount; ++day) {
+            if (day > 0) market.simulateFluctuation();
+
+            const StockTable& table = market.getStockTable();
+            MarketBar* row = &out.storage[day * out.stockCount];
+
+            for (size_t s = 0; s < out.stockCount; ++s) {
+                row[s] = MarketBar{ table.getCurrentPrice(s), table.getVolume(s) };
+            }
+        }
+
+        out.bars = out.storage.data();
+
+        return out;
+    }
+
+    // 과거 시세 파일을 경로로 사용 (매핑 메모리를 그대로 가리킴, replay는 탐색이 끝날 때까지 열려 있어야 함)
+    static MarketPath replayPath(const MarketReplay& replay) {
+        MarketPath out;
+        out.stockCount = replay.getStockCount();
+        out.dayCount = replay.getDayCount();
+        out.bars = out.dayCount > 0 ? replay.bars(0) : nullptr;
+
+        for (size_t s = 0; s < out.stockCount; ++s) {
+            out.names.push_back(replay.getName(s));
+        }
+
+        return out;
+    }
+
+    // 격자 탐색: 축별 후보값의 모든 조합 (5 x 4 x 4 x 4 x 5 x 3 = 4800개)
+    static vector<StrategyParams> grid() {
+        const double targets[] = { 0.05, 0.10, 0.15, 0.20, 0.30 };
+        const double stopLosses[] = { -0.05, -0.10, -0.20, -0.30 };
+        const double ratios[] = { 0.10, 0.25, 0.50, 0.75 };
+        const int positions[] = { 1, 2, 3, 5 };
+        const double thresholds[] = { 30.0, 50.0, 70.0, 100.0, 150.0 };
+        const double recoveryFactors[] = { 0.5, 0.7, 1.0 };     // 복귀 점수 = 전환 점수 x 계수
+
+        vector<StrategyParams> sets;
+
+        for (double target : targets)
+            for (double stopLoss : stopLosses)
+                for (double ratio : ratios)
+                    for (int maxPositions : positions)
+                        for (double threshold : thresholds)
+                            for (double factor : recoveryFactors) {
+                                StrategyParams p;
+                                p.targetProfitRate = target;
+                                p.stopLossRate = stopLoss;
+                                p.investmentRatio = ratio;
+                                p.maxPositions = maxPositions;
+                                p.threshold = threshold;
+                                p.recoveryThreshold = threshold * factor;
+                                sets.push_back(p);
+                            }
+
+        return sets;
+    }
+
+    // 무작위 탐색: 격자와 같은 범위에서 count개 균등 추출 (Philox, 시드 고정 -> 재현 가능)
+    static vector<StrategyParams> random(size_t count, uint64_t seed) {
+        vector<StrategyParams> sets(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            Philox4x32::Counter a = Philox4x32::generate(seed, 0, i);
+            Philox4x32::Counter b = Philox4x32::generate(seed, 1, i);
+            StrategyParams& p = sets[i];
+
+            p.targetProfitRate = 0.05 + Philox4x32::toUnit(a[0]) * 0.25;
+            p.stopLossRate = -0.05 - Philox4x32::toUnit(a[1]) * 0.25;
+            p.investmentRatio = 0.10 + Philox4x32::toUnit(a[2]) * 0.65;
+            p.maxPositions = 1 + static_cast<int>(Philox4x32::toUnit(a[3]) * 5);
+            p.threshold = 30.0 + Philox4x32::toUnit(b[0]) * 120.0;
+            p.recoveryThreshold = p.threshold * (0.5 + Philox4x32::toUnit(b[1]) * 0.5);
+        }
+
+        return sets;
+    }
+
+    // 모든 조합을 병렬 평가 후 순위대로 반환
+    vector<Result> run(const vector<StrategyParams>& sets, ThreadPool& pool) const {
+        vector<Result> results(sets.size());
+        size_t tasks = (sets.size() + SETS_PER_TASK - 1) / SETS_PER_TASK;
+
+        pool.parallelFor(tasks, [&](size_t task) {
+            size_t end = min(sets.size(), (task + 1) * SETS_PER_TASK);
+            Arena arena;
+
+            for (size_t i = task * SETS_PER_TASK; i < end; ++i) {
+                results[i] = evaluate(i, sets[i], &arena);
+                arena.reset();
+            }
+        });
+
+        // 동률이면 조합 번호 순 -> 스레드 수와 무관하게 같은 순위
+        sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+            if (a.finalAsset != b.finalAsset) return a.finalAsset > b.finalAsset;
+            if (a.maxDrawdown != b.maxDrawdown) return a.maxDrawdown < b.maxDrawdown;
+
+            return a.index < b.index;
+        });
+
+        return results;
+    }
+
+    // 기본 매개변수 (명세서 값)로 같은 경로를 평가 -> 비교 기준
+    Result baseline() const {
+        return evaluate(0, StrategyParams());
+    }
+};
+
+// --sweep 실행: 경로 준비 -> 조합 평가 -> 상위 top개와 기본 매개변수 결과 출력
+int runSweep(ThreadPool& pool, const string& mode, size_t top, uint64_t seed, int days, const string& replayFile,
+             const FactorModel::Config* factors) {
+    Logger::setLevel(LogLevel::Error);
+
+    MarketReplay replay;
+    ParameterSweep::MarketPath path;
+
+    if (!replayFile.empty()) {
+        if (!replay.open(replayFile) || replay.getDayCount() < 2) {
+            Logger::error("[오류] 시세 파일을 열 수 없음: ", replayFile);
+            return 1;
+        }
+
+        path = ParameterSweep::replayPath(replay);
+        path.dayCount = min(path.dayCount, static_cast<size_t>(days) + 1);
+    }
+
+    else {
+        path = ParameterSweep::generatePath(seed, days, &pool, factors);
+    }
+
+    vector<StrategyParams> sets = mode == "grid"
+        ? ParameterSweep::grid()
+        : ParameterSweep::random(strtoull(mode.c_str(), nullptr, 10), seed);
+
+    if (sets.empty()) {
+        Logger::error("[오류] --sweep 값은 grid 또는 조합 수");
+        return 1;
+    }
+
+    cout << "[매개변수 탐색] 조합: " << sets.size() << " (" << (mode == "grid" ? "격자" : "무작위") << ")"
+         << " | 일수: " << path.dayCount - 1 << " | 종목: " << path.stockCount
+         << " | 스레드: " << pool.size() << endl;
+
+    ParameterSweep sweep(path, 10000000.0);
+
+    auto start = chrono::steady_clock::now();
+    vector<ParameterSweep::Result> results = sweep.run(sets, pool);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto printRow = [](const string& rank, const ParameterSweep::Result& r) {
+        cout << setw(6) << rank << fixed
+             << " | 자산 x" << setprecision(4) << r.finalAsset
+             << " | 낙폭 " << setprecision(2) << setw(6) << r.maxDrawdown * 100 << "%"
+             << " | 전환 " << setw(3) << r.transitions
+             << " | 목표 " << setprecision(2) << r.params.targetProfitRate
+             << " 손절 " << r.params.stopLossRate
+             << " 투자 " << r.params.investmentRatio
+             << " 포지션 " << r.params.maxPositions
+             << " 전환점수 " << setprecision(1) << r.params.threshold
+             << " 복귀점수 " << r.params.recoveryThreshold << endl;
+    };
+
+    cout << "\n[상위 " << min(top, results.size()) << "개]" << endl;
+
+    for (size_t i = 0; i < results.size() && i < top; ++i) {
+        printRow("#" + to_string(i + 1), results[i]);
+    }
+
+    cout << "\n[기본 매개변수]" << endl;
+    printRow("  기본", sweep.baseline());
+
+    cout << "\n[처리 시간]: " << fixed << setprecision(3) << seconds << "s"
+         << " | 처리량: " << fixed << setprecision(0) << (sets.size() / seconds) << " 조합/s" << endl;
+
+    return 0;
+}
+
+// ============================================================
+// 공통: AgentSimulation (다수 Trader 동시 매매)
+// ============================================================
+// 하나의 Market에서 전략 매개변수와 초기 자본이 서로 다른 Trader 수천 명이 매일 동시에 자동매매한다.
+// 시세 변동 후 Market::beginConcurrentTrading()으로 동시 매매 구간을 열고, 에이전트 블록을 작업 훔치기 풀에 분배한다.
+// 거래 내역은 스레드별 버퍼에 에이전트 번호와 함께 쌓았다가 마감 때 에이전트 번호 순으로 저널에 병합하므로 전역 잠금이 없다.
+// 주문장을 켜면 매매 중에는 현재가로 잠정 체결하고, 모든 에이전트가 끝난 뒤 (에이전트 번호, 주문 순서)대로
+// 종목 샤드별로 체결해 잠정 체결을 정산한다. 따라서 결과와 저널은 스레드 수·작업 배치와 무관하다.
+class AgentSimulation {
+public:
+    struct Config {
+        size_t agents = 1000;
+        int days = 10;
+        uint64_t seed = 0;
+        bool orderBook = false;
+        const FactorModel::Config* factorModel = nullptr;   // nullptr이면 종목별 독립 변동
+    };
+
+    struct Result {
+        uint64_t transactions = 0;
+        double seconds = 0.0;           // 매매 구간(시세 변동 포함) 처리 시간
+        double best = 0.0;              // 최종 자산 / 초기 자본
+        double median = 0.0;
+        double worst = 0.0;
+        double mean = 0.0;
+    };
+
+private:
+    static constexpr size_t AGENTS_PER_TASK = 32;
+    static constexpr uint64_t AGENT_STREAM = 0xA6E7;
+
+    Config cfg;
+
+public:
+    explicit AgentSimulation(const Config& cfg) : cfg(cfg) {}
+
+    Result run(ThreadPool& pool) const {
+        Market market(cfg.seed);
+        market.setThreadPool(&pool);
+        populateDefaultMarket(market);
+
+        if (cfg.orderBook) market.enableOrderBooks();
+        if (cfg.factorModel) market.enableFactorModel(*cfg.factorModel);
+
+        // 에이전트별 전략 매개변수 (탐색과 같은 범위) + 초기 자본 100만 ~ 1억 (로그 균등)
+        uint64_t stream = mixSeed(cfg.seed, AGENT_STREAM);
+        vector<StrategyParams> params = ParameterSweep::random(cfg.agents, stream);
+        vector<unique_ptr<Trader>> traders;
+        vector<double> initialCash(cfg.agents);
+        traders.reserve(cfg.agents);
+
+        for (size_t i = 0; i < cfg.agents; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(stream, 2, i);
+            initialCash[i] = 1000000.0 * pow(100.0, Philox4x32::toUnit(r[0]));
+            traders.push_back(make_unique<Trader>("Agent " + to_string(i), initialCash[i], params[i]));
+        }
+
+        size_t tasks = (cfg.agents + AGENTS_PER_TASK - 1) / AGENTS_PER_TASK;
+        auto start = chrono::steady_clock::now();
+
+        for (int day = 1; day <= cfg.days; ++day) {
+            market.simulateFluctuation();
+            market.beginConcurrentTrading();
+
+            pool.parallelFor(tasks, [&](size_t task) {
+                size_t end = min(cfg.agents, (task + 1) * AGENTS_PER_TASK);
+
+                for (size_t i = task * AGENTS_PER_TASK; i < end; ++i) {
+                    market.setConcurrentAgent(static_cast<uint32_t>(i));
+                    traders[i]->autoTrade(market);
+                }
+            });
+
+            // 주문장 체결은 병렬 구간이 끝난 뒤 에이전트 번호 순으로 하고, 그 결과로 잠정 체결을 정산
+            if (cfg.orderBook) {
+                market.matchDeferredOrders();
+
+                pool.parallelFor(tasks, [&](size_t task) {
+                    size_t end = min(cfg.agents, (task + 1) * AGENTS_PER_TASK);
+
+                    for (size_t i = task * AGENTS_PER_TASK; i < end; ++i) {
+                        market.setConcurrentAgent(static_cast<uint32_t>(i));
+                        traders[i]->settleDeferredOrders(market);
+                    }
+                });
+            }
+
+            market.endConcurrentTrading();
+        }
+
+        Result result;
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.transactions = market.getTransactionHistory().size();
+
+        if (cfg.agents == 0) return result;
+
+        vector<double> multiples(cfg.agents);
+
+        for (size_t i = 0; i < cfg.agents; ++i) {
+            multiples[i] = traders[i]->getTotalAssetValue(market) / initialCash[i];
+            result.mean += multiples[i] / cfg.agents;
+        }
+
+        sort(multiples.begin(), multiples.end());
+        result.worst = multiples.front();
+        result.median = multiples[multiples.size() / 2];
+        result.best = multiples.back();
+
+        return result;
+    }
+};
+
+// ============================================================
+// 공통: SnapshotForks (스냅샷 시점에서 갈라지는 what-if 분기)
+// ============================================================
+// 같은 스냅샷에서 분기마다 Market + Trader를 복원하고 시드만 바꿔 days일을 이어서 자동매매한다.
+// 매핑된 스냅샷과 종목명 표는 모든 분기가 읽기 전용으로 공유하며, 분기별 데이터는 작업별 Arena에 두고 분기마다 reset한다.
+class SnapshotForks {
+public:
+    struct Config {
+        size_t branches = 1000;
+        int days = 10;
+        uint64_t seed = 0;          // 분기 b의 시드 = mixSeed(seed, b)
+        const FactorModel::Config* factorModel = nullptr;   // nullptr이면 종목별 독립 변동
+    };
+
+    struct Result {
+        double seconds = 0.0;
+        double best = 0.0;          // 분기 최종 자산 / 스냅샷 시점 자산 (스냅샷의 모든 트레이더 합계)
+        double median = 0.0;
+        double worst = 0.0;
+        double mean = 0.0;
+    };
+
+private:
+    static constexpr size_t BRANCHES_PER_TASK = 16;
+
+    Config cfg;
+
+    // 분기 데이터는 arena에 두고, 함수가 끝나 객체가 소멸한 뒤 호출자가 reset
+    double runBranch(const SimulationSnapshot& snapshot, size_t branch, Arena& arena) const {
+        Market market(0, &arena);
+        snapshot.restoreMarket(market);
+        market.setSeed(mixSeed(cfg.seed, branch));
+
+        if (cfg.factorModel) market.enableFactorModel(*cfg.factorModel);
+
+        vector<ArenaPtr<Trader>> traders;
+        traders.reserve(snapshot.getTraderCount());
+
+        for (size_t i = 0; i < snapshot.getTraderCount(); ++i) {
+            traders.push_back(snapshot.restoreTrader(i, market, &arena));
+        }
+
+        for (int day = 1; day <= cfg.days; ++day) {
+            market.simulateFluctuation();
+
+            for (auto& trader : traders) trader->autoTrade(market);
+        }
+
+        double total = 0.0;
+        for (auto& trader : traders) total += trader->getTotalAssetValue(market);
+
+        return total;
+    }
+
+public:
+    explicit SnapshotForks(const Config& cfg) : cfg(cfg) {}
+
+    Result run(const SimulationSnapshot& snapshot, ThreadPool& pool) const {
+        Result result;
+
+        if (cfg.branches == 0) return result;
+
+        // 스냅샷 시점 자산 (기준값)
+        double initial = 0.0;
+        {
+            Market market;
+            snapshot.restoreMarket(market);
+
+            for (size_t i = 0; i < snapshot.getTraderCount(); ++i) {
+                initial += snapshot.restoreTrader(i, market)->getTotalAssetValue(market);
+            }
+        }
+
+        vector<double> multiples(cfg.branches);
+        size_t tasks = (cfg.branches + BRANCHES_PER_TASK - 1) / BRANCHES_PER_TASK;
+        auto start = chrono::steady_clock::now();
+
+        pool.parallelFor(tasks, [&](size_t task) {
+            size_t end = min(cfg.branches, (task + 1) * BRANCHES_PER_TASK);
+            Arena arena;
+
+            for (size_t b = task * BRANCHES_PER_TASK; b < end; ++b) {
+                multiples[b] = runBranch(snapshot, b, arena) / initial;
+                arena.reset();
+            }
+        });
+
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        for (double m : multiples) result.mean += m / cfg.branches;
+
+        sort(multiples.begin(), multiples.end());
+        result.worst = multiples.front();
+        result.median = multiples[multiples.size() / 2];
+        result.best = multiples.back();
+
+        return result;
+    }
+};
+
+#ifdef STOCKSIM_COROUTINES
+// ============================================================
+// 공통: StrategyExecutor (C++20 코루틴 전략 실행, -std=c++20 빌드에서만)
+// ============================================================
+// MarketState::handle()은 autoTrade 한 번 안에 끝나야 하므로 "안정화 2일 뒤 매수" 같은 대기 전략은
+// 단계와 남은 일수를 직접 들고 있어야 한다. 코루틴 전략은 기다림을 co_await로 그대로 쓴다.
+//   co_await exec.nextDay();                      다음 장 마감까지 (장중이면 오늘 마감)
+//   co_await exec.days(n);                        n번째 장 마감까지
+//   co_await exec.sleepUntil(t);                  가상 시각 t까지
+//   co_await exec.nextTick(id);                   종목 id의 다음 장중 틱 (IntradaySimulator::setTickHook으로 연결)
+//   co_await event;                               StrategyEvent::notify() (시장 사건)
+//   bool filled = co_await exec.buy(trader, id, qty);   주문을 내고 체결 결과를 기다림 (close는 갭 포지션 청산)
+// 실행기는 단일 스레드다. 시장을 진행시키는 쪽이 run()/onTick()을 부르면 깨어난 코루틴을 깨어난 순서대로 재개하고,
+// 그동안 모인 주문을 도착 순서대로 체결한 뒤 주문한 코루틴을 다시 재개한다 (같은 입력이면 같은 순서).
+// 대기 노드는 코루틴 프레임 안의 awaiter에 들어 있어(침입형 목록) 기다리는 동안 할당이 없고,
+// 프레임은 스레드별 크기 등급 풀(StrategyFramePool)에서 받는다 -> 코루틴 수만 개를 만들고 끝내도 힙 할당은 풀 블록뿐.
+
+// 코루틴 프레임 풀: 64바이트 단위 크기 등급별 자유 목록 + 256KB 블록 bump 할당 (스레드별이라 잠금 없음).
+// 프레임은 만든 스레드에서 해제해야 한다 (실행기가 단일 스레드이므로 항상 만족). 블록은 스레드가 끝날 때 해제.
+class StrategyFramePool {
+public:
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t MAX_POOLED = 4096;          // 이보다 큰 프레임은 전역 operator new
+    static constexpr size_t BLOCK_BYTES = 256 * 1024;
+
+    struct Stats {
+        size_t live = 0;            // 살아 있는 프레임 수
+        size_t peak = 0;
+        size_t largestFrame = 0;    // 바이트
+        size_t blockBytes = 0;      // 풀 블록 합계
+    };
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    array<FreeNode*, MAX_POOLED / GRANULE> freeLists{};
+    vector<unique_ptr<unsigned char[]>> blocks;
+    unsigned char* cursor = nullptr;
+    size_t remaining = 0;
+    Stats stats;
+
+public:
+    static StrategyFramePool& local() {
+        static thread_local StrategyFramePool pool;
+        return pool;
+    }
+
+    void* allocate(size_t bytes) {
+        stats.peak = max(stats.peak, ++stats.live);
+        stats.largestFrame = max(stats.largestFrame, bytes);
+
+        if (bytes > MAX_POOLED) return ::operator new(bytes);
+
+        size_t cls = (max<size_t>(bytes, 1) - 1) / GRANULE;
+
+        if (FreeNode* node = freeLists[cls]) {
+            freeLists[cls] = node->next;
+            return node;
+        }
+
+        size_t size = (cls + 1) * GRANULE;
+
+        if (remaining < size) {
+            blocks.emplace_back(new unsigned char[BLOCK_BYTES]);
+            cursor = blocks.back().get();
+            remaining = BLOCK_BYTES;
+            stats.blockBytes += BLOCK_BYTES;
+        }
+
+        void* p = cursor;
+        cursor += size;
+        remaining -= size;
+
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes) {
+        --stats.live;
+
+        if (bytes > MAX_POOLED) {
+            ::operator delete(p);
+            return;
+        }
+
+        size_t cls = (max<size_t>(bytes, 1) - 1) / GRANULE;
+        FreeNode* node = static_cast<FreeNode*>(p);
+        node->next = freeLists[cls];
+        freeLists[cls] = node;
+    }
+
+    const Stats& getStats() const { return stats; }
+};
+
+// 전략 코루틴 반환 형식. 만들어지면 첫 줄 전에 멈춰 있다가 StrategyExecutor::spawn()으로 넘기면 실행기가 소유한다.
+class StrategyTask {
+public:
+    struct promise_type {
+        size_t slot = 0;    // StrategyExecutor의 살아 있는 코루틴 목록 안 위치
+
+        static void* operator new(size_t bytes) { return StrategyFramePool::local().allocate(bytes); }
+
+        static void operator delete(void* p, size_t bytes) { StrategyFramePool::local().deallocate(p, bytes); }
+
+        StrategyTask get_return_object() { return StrategyTask(coroutine_handle<promise_type>::from_promise(*this)); }
+
+        suspend_always initial_suspend() noexcept { return {}; }
+
+        // 끝나면 멈춰 두고 실행기가 done()을 보고 해제
+        suspend_always final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        // 전략 코루틴은 예외를 밖으로 던지지 않는다
+        void unhandled_exception() { terminate(); }
+    };
+
+private:
+    coroutine_handle<promise_type> handle;
+
+    explicit StrategyTask(coroutine_handle<promise_type> h) : handle(h) {}
+
+public:
+    StrategyTask(StrategyTask&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+
+    StrategyTask(const StrategyTask&) = delete;
+    StrategyTask& operator=(const StrategyTask&) = delete;
+
+    ~StrategyTask() {
+        if (handle) handle.destroy();
+    }
+
+    coroutine_handle<promise_type> release() { return exchange(handle, nullptr); }
+};
+
+class StrategyExecutor {
+public:
+    // 대기 노드 (awaiter 안에 있음, 기다리는 동안만 목록에 연결)
+    struct Waiter {
+        coroutine_handle<> handle;
+        Waiter* next = nullptr;
+    };
+
+    // 기다린 순서를 유지하는 침입형 목록
+    struct WaitList {
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+
+        void push(Waiter* w) {
+            w->next = nullptr;
+
+            if (tail) tail->next = w;
+            else head = w;
+
+            tail = w;
+        }
+
+        // 목록을 통째로 떼어 냄 (첫 노드 반환)
+        Waiter* take() {
+            Waiter* first = head;
+            head = tail = nullptr;
+
+            return first;
+        }
+
+        bool empty() const { return head == nullptr; }
+    };
+
+    struct Stats {
+        uint64_t resumes = 0;       // 코루틴 재개 횟수
+        uint64_t orders = 0;        // 체결 시도한 주문 수
+        uint64_t fills = 0;         // 체결된 주문 수
+        size_t peakTasks = 0;       // 동시에 살아 있던 코루틴 수
+    };
+
+    class OrderAwait;
+
+private:
+    struct Timer {
+        SimTime at;
+        uint64_t sequence;
+        coroutine_handle<> handle;
+
+        // 최소 힙: 이른 시각 -> 먼저 잠든 순서
+        static bool later(const Timer& a, const Timer& b) {
+            return a.at != b.at ? a.at > b.at : a.sequence > b.sequence;
+        }
+    };
+
+    Market& market;
+
+    // 살아 있는 코루틴 (끝나면 swap-erase, promise_type::slot이 위치)
+    vector<coroutine_handle<StrategyTask::promise_type>> tasks;
+
+    // 이번 라운드에 재개할 코루틴 / 재개 중인 라운드
+    vector<coroutine_handle<>> ready;
+    vector<coroutine_handle<>> running;
+
+    vector<Timer> timers;
+    uint64_t timerSequence = 0;
+    vector<WaitList> tickWaiters;       // [SymbolId]
+    vector<OrderAwait*> orders;
+    vector<OrderAwait*> ordersRunning;
+
+    Stats stats;
+
+    void retire(coroutine_handle<> h) {
+        auto task = coroutine_handle<StrategyTask::promise_type>::from_address(h.address());
+        size_t slot = task.promise().slot;
+
+        tasks[slot] = tasks.back();
+        tasks[slot].promise().slot = slot;
+        tasks.pop_back();
+
+        task.destroy();
+    }
+
+    // 깨어난 코루틴을 모두 재개하고, 모인 주문을 체결해 주문한 코루틴을 다시 깨움 (더 깨어날 것이 없을 때까지)
+    void drain();
+
+public:
+    explicit StrategyExecutor(Market& market) : market(market) {}
+
+    // 끝나지 않은 코루틴(무한 루프 전략 등)은 여기서 프레임째 해제
+    ~StrategyExecutor() {
+        for (coroutine_handle<StrategyTask::promise_type> task : tasks) task.destroy();
+    }
+
+    StrategyExecutor(const StrategyExecutor&) = delete;
+    StrategyExecutor& operator=(const StrategyExecutor&) = delete;
+
+    // 코루틴을 넘겨받아 다음 run()에서 시작
+    void spawn(StrategyTask task) {
+        coroutine_handle<StrategyTask::promise_type> h = task.release();
+
+        h.promise().slot = tasks.size();
+        tasks.push_back(h);
+        ready.push_back(h);
+
+        stats.peakTasks = max(stats.peakTasks, tasks.size());
+    }
+
+    // 다음 라운드에 재개 (StrategyEvent::notify에서 사용)
+    void schedule(coroutine_handle<> h) { ready.push_back(h); }
+
+    SimTime now() const { return market.now(); }
+
+    Market& getMarket() const { return market; }
+
+    size_t size() const { return tasks.size(); }
+
+    const Stats& getStats() const { return stats; }
+
+    // 시장 시각까지 만료된 타이머를 깨우고 실행 (시장을 진행시킨 뒤 호출: 일자 마감, 장중 틱)
+    void run() {
+        SimTime t = market.now();
+
+        while (!timers.empty() && timers.front().at <= t) {
+            pop_heap(timers.begin(), timers.end(), Timer::later);
+            ready.push_back(timers.back().handle);
+            timers.pop_back();
+        }
+
+        drain();
+    }
+
+    // 종목 id의 장중 틱: 그 틱을 기다리던 코루틴을 깨우고 실행
+    void onTick(SymbolId id) {
+        size_t i = static_cast<size_t>(id);
+
+        if (i < tickWaiters.size()) {
+            for (Waiter* w = tickWaiters[i].take(); w;) {
+                Waiter* next = w->next;
+                ready.push_back(w->handle);
+                w = next;
+            }
+        }
+
+        run();
+    }
+
+    // ---------- awaitable ----------
+
+    class SleepAwait {
+    private:
+        StrategyExecutor& exec;
+        SimTime at;
+
+    public:
+        SleepAwait(StrategyExecutor& exec, SimTime at) : exec(exec), at(at) {}
+
+        bool await_ready() const { return at <= exec.now(); }
+
+        void await_suspend(coroutine_handle<> h) {
+            exec.timers.push_back(Timer{ at, exec.timerSequence++, h });
+            push_heap(exec.timers.begin(), exec.timers.end(), Timer::later);
+        }
+
+        void await_resume() const {}
+    };
+
+    class TickAwait {
+    private:
+        StrategyExecutor& exec;
+        SymbolId id;
+        Waiter waiter;
+
+    public:
+        TickAwait(StrategyExecutor& exec, SymbolId id) : exec(exec), id(id) {}
+
+        // 없는 종목이면 기다리지 않음
+        bool await_ready() const { return id < 0; }
+
+        void await_suspend(coroutine_handle<> h) {
+            size_t i = static_cast<size_t>(id);
+            if (i >= exec.tickWaiters.size()) exec.tickWaiters.resize(i + 1);
+
+            waiter.handle = h;
+            exec.tickWaiters[i].push(&waiter);
+        }
+
+        void await_resume() const {}
+    };
+
+    class OrderAwait {
+        friend class StrategyExecutor;
+
+    private:
+        StrategyExecutor& exec;
+        Trader& trader;
+        SymbolId id;
+        int quantity;
+        bool closing;
+        bool filled = false;
+        coroutine_handle<> handle;
+
+        void execute(Market& m) {
+            filled = closing ? trader.closeGapPosition(id, m) : trader.buyGapPosition(id, quantity, m);
+        }
+
+    public:
+        OrderAwait(StrategyExecutor& exec, Trader& trader, SymbolId id, int quantity, bool closing)
+            : exec(exec), trader(trader), id(id), quantity(quantity), closing(closing) {}
+
+        bool await_ready() const { return false; }
+
+        void await_suspend(coroutine_handle<> h) {
+            handle = h;
+            exec.orders.push_back(this);
+        }
+
+        bool await_resume() const { return filled; }
+    };
+
+    SleepAwait sleepUntil(SimTime t) { return SleepAwait(*this, t); }
+
+    // n번째로 다가오는 장 마감. 시장의 마지막 마감이 getDay()일이므로 (장중이면 오늘 마감이 첫 번째)
+    SleepAwait days(int n) {
+        return SleepAwait(*this, SimClock::at(market.getDay() + static_cast<uint64_t>(max(n, 1)), SimClock::SESSION_CLOSE));
+    }
+
+    SleepAwait nextDay() { return days(1); }
+
+    TickAwait nextTick(SymbolId id) { return TickAwait(*this, id); }
+
+    // 갭 포지션 매수 주문 (체결 수량이 없으면 false)
+    OrderAwait buy(Trader& trader, SymbolId id, int qty) { return OrderAwait(*this, trader, id, qty, false); }
+
+    // 갭 포지션 전량 청산 주문
+    OrderAwait close(Trader& trader, SymbolId id) { return OrderAwait(*this, trader, id, 0, true); }
+};
+
+inline void StrategyExecutor::drain() {
+    while (!ready.empty() || !orders.empty()) {
+        running.swap(ready);
+
+        for (coroutine_handle<> h : running) {
+            ++stats.resumes;
+            h.resume();
+
+            if (h.done()) retire(h);
+        }
+
+        running.clear();
+
+        // 이번 라운드에 모인 주문을 도착 순서대로 체결
+        ordersRunning.swap(orders);
+
+        for (OrderAwait* order : ordersRunning) {
+            order->execute(market);
+            ++stats.orders;
+            stats.fills += order->filled;
+
+            ready.push_back(order->handle);
+        }
+
+        ordersRunning.clear();
+    }
+}
+
+// 방송형 시장 사건: co_await event로 기다리고, notify()는 기다리던 코루틴을 모두 다음 라운드에 재개하도록 넘긴다
+class StrategyEvent {
+private:
+    StrategyExecutor& exec;
+    StrategyExecutor::WaitList waiters;
+
+public:
+    explicit StrategyEvent(StrategyExecutor& exec) : exec(exec) {}
+
+    class Await {
+    private:
+        StrategyEvent& event;
+        StrategyExecutor::Waiter waiter;
+
+    public:
+        explicit Await(StrategyEvent& event) : event(event) {}
+
+        bool await_ready() const { return false; }
+
+        void await_suspend(coroutine_handle<> h) {
+            waiter.handle = h;
+            event.waiters.push(&waiter);
+        }
+
+        void await_resume() const {}
+    };
+
+    Await operator co_await() { return Await(*this); }
+
+    void notify() {
+        for (StrategyExecutor::Waiter* w = waiters.take(); w;) {
+            StrategyExecutor::Waiter* next = w->next;
+            exec.schedule(w->handle);
+            w = next;
+        }
+    }
+
+    bool hasWaiters() const { return !waiters.empty(); }
 };
 
 // ============================================================
-// 팀원 C: NormalState 클래스
+// 공통: CoroutineStrategies (코루틴 전략 다수 동시 실행, -std=c++20 빌드에서만)
 // ============================================================
-class NormalState : public MarketState {
+// 하나의 Market에서 코루틴 전략 수만 개를 단일 스레드 실행기로 돌린다. 전략마다 Trader 하나이고 흐름은
+//  1) 급락 사건(그날 급락 후보가 있으면 notify)을 기다렸다가 후보 하나를 고름
+//  2) 안정화: |변동률| < 1%인 장 마감이 stableDays일 연속될 때까지 기다림 (10일 안에 안 되면 처음으로)
+//  3) 매수 주문을 내고 체결을 기다림
+//  4) 보유: 손절 기준 이하면 바로, 종가가 매수가 위인 날이 recoveryDays일 이어지면 청산
+//     (장중 모드에서는 대상 종목의 틱마다 손절 확인)
+// 이 흐름을 MarketState로 쓰면 단계, 대기 일수, 대상 종목을 Trader 상태로 직접 들고 다녀야 한다.
+class CoroutineStrategies {
+public:
+    struct Config {
+        size_t strategies = 10000;
+        int days = 10;
+        uint64_t seed = 0;
+        uint32_t intradayTicks = 0;                         // 0이면 일별 변동
+        const FactorModel::Config* factorModel = nullptr;   // nullptr이면 종목별 독립 변동
+    };
+
+    struct Result {
+        uint64_t transactions = 0;
+        size_t holding = 0;             // 끝날 때 포지션을 들고 있는 전략 수
+        double seconds = 0.0;
+        double best = 0.0;              // 최종 자산 / 초기 자본
+        double median = 0.0;
+        double worst = 0.0;
+        double mean = 0.0;
+        StrategyExecutor::Stats executor;
+        StrategyFramePool::Stats frames;
+    };
+
 private:
-    static constexpr double TARGET_PROFIT_RATE = 0.10;   // 목표 수익률 10%
-    static constexpr double STOP_LOSS_RATE = -0.20;      // 손절 기준 -20%
+    static constexpr uint64_t STRATEGY_STREAM = 0xC0DE;
+    static constexpr double INITIAL_CASH = 10000000.0;
+    static constexpr size_t SCREEN_SIZE = 16;
+    static constexpr double FALL_THRESHOLD = -0.15;         // 급락 후보: DisruptedState와 같은 기준
+    static constexpr double VOLUME_RATIO_THRESHOLD = 2.0;
+    static constexpr double CALM_RATE = 0.01;
+    static constexpr int MAX_STABILIZE_DAYS = 10;
+
+    // 전략 코루틴이 함께 보는 상태 (그날 급락 후보)
+    struct Shared {
+        Market& market;
+        StrategyExecutor& exec;
+        StrategyEvent& crash;
+        vector<StockTable::Candidate> screened;
+        size_t screenedCount;
+        bool intraday;
+    };
+
+    Config cfg;
+
+    static StrategyTask strategy(Shared& s, Trader& trader, size_t index, int stableDays, int recoveryDays) {
+        const StockTable& table = s.market.getStockTable();
+        const StrategyParams& params = trader.getParams();
+
+        while (true) {
+            co_await s.crash;
+
+            size_t i = s.screened[index % s.screenedCount].index;
+            SymbolId target = static_cast<SymbolId>(i);
+
+            // 안정화 대기
+            int calm = 0;
+
+            for (int waited = 0; calm < stableDays && waited < MAX_STABILIZE_DAYS; ++waited) {
+                co_await s.exec.nextDay();
+
+                double rate = StockTable::fluctuationRate(table.getCurrentPrice(i), table.getPreviousPrice(i));
+                calm = fabs(rate) < CALM_RATE ? calm + 1 : 0;
+            }
 
-public:
-    void handle(Trader& t, Market& m) override {
-        // 보수적 리밸런싱, 갭 포지션 청산 검사
-        checkGapPositionRecovery(t, m);
-    }
+            if (calm < stableDays) continue;
 
-    string getStateName() const override { return "Normal"; }
+            int qty = static_cast<int>(floor(trader.getCash() * params.investmentRatio / table.getCurrentPrice(i)));
+            if (qty <= 0) continue;
 
-    void checkGapPositionRecovery(Trader& t, Market& m) {
-        // 갭 포지션 순회 -> 목표 수익률 달성 또는 손절 기준 도달 시 청산
-        vector<pair<string, string>> toClose;  // (종목명, 청산사유)
+            bool filled = co_await s.exec.buy(trader, target, qty);
+            if (!filled) continue;
+
+            double buyPrice = trader.getGapPositions().find(target)->avgBuyPrice;
+            uint64_t judgedDay = s.market.getDay();
+            int recovering = 0;
 
-        for (const auto& kv : t.getGapPositions()) {
-            const string& name = kv.first;
-            double profitRate = t.getGapPositionProfit(name);
+            while (true) {
+                if (s.intraday) co_await s.exec.nextTick(target);
+                else co_await s.exec.nextDay();
 
-            if (profitRate >= TARGET_PROFIT_RATE) {
-                toClose.push_back({name, "목표수익"});
-            } else if (profitRate <= STOP_LOSS_RATE) {
-                toClose.push_back({name, "손절"});
+                if ((table.getCurrentPrice(i) - buyPrice) / buyPrice <= params.stopLossRate) break;
+
+                // 회복 판단은 장 마감 종가로 하루 한 번 (장중 모드는 새 날 첫 틱에서 전일가 = 직전 종가)
+                if (s.market.getDay() == judgedDay) continue;
+
+                judgedDay = s.market.getDay();
+                double close = s.intraday ? table.getPreviousPrice(i) : table.getCurrentPrice(i);
+                recovering = close > buyPrice ? recovering + 1 : 0;
+
+                if (recovering >= recoveryDays) break;
             }
+
+            co_await s.exec.close(trader, target);
         }
+    }
 
-        for (const auto& item : toClose) {
-            const string& name = item.first;
-            const string& reason = item.second;
-            double profitRate = t.getGapPositionProfit(name);
+public:
+    explicit CoroutineStrategies(const Config& cfg) : cfg(cfg) {}
 
-            if (reason == "목표수익") {
-                cout << "[NormalState] 갭 포지션 목표 수익 달성: " << name
-                     << " (수익률: " << fixed << setprecision(2) << (profitRate * 100) << "%) 청산 수행" << endl;
-            } else {
-                cout << "[NormalState] 갭 포지션 손절: " << name
-                     << " (수익률: " << fixed << setprecision(2) << (profitRate * 100) << "%) 손절 수행" << endl;
-            }
-            t.closeGapPosition(name, m);
+    Result run(ThreadPool& pool) const {
+        Market market(cfg.seed);
+        market.setThreadPool(&pool);
+        populateDefaultMarket(market);
+
+        if (cfg.factorModel) market.enableFactorModel(*cfg.factorModel);
+
+        // 전략별 매개변수 (탐색과 같은 범위) + 안정화 1 ~ 3일, 회복 1 ~ 4일
+        uint64_t stream = mixSeed(cfg.seed, STRATEGY_STREAM);
+        vector<StrategyParams> params = ParameterSweep::random(cfg.strategies, stream);
+        vector<unique_ptr<Trader>> traders;
+        traders.reserve(cfg.strategies);
+
+        StrategyExecutor exec(market);
+        StrategyEvent crash(exec);
+        Shared shared{ market, exec, crash, vector<StockTable::Candidate>(SCREEN_SIZE), 0, cfg.intradayTicks > 0 };
+
+        for (size_t i = 0; i < cfg.strategies; ++i) {
+            Philox4x32::Counter r = Philox4x32::generate(stream, 3, i);
+            traders.push_back(make_unique<Trader>("Strategy " + to_string(i), INITIAL_CASH, params[i]));
+
+            exec.spawn(strategy(shared, *traders.back(), i, 1 + static_cast<int>(r[0] % 3), 1 + static_cast<int>(r[1] % 4)));
+        }
+
+        // 모든 전략을 첫 대기까지 진행
+        exec.run();
+
+        IntradaySimulator intraday(market, max<uint32_t>(cfg.intradayTicks, 1));
+        if (shared.intraday) intraday.setTickHook([&](SymbolId id) { exec.onTick(id); });
+
+        auto start = chrono::steady_clock::now();
+
+        for (int day = 1; day <= cfg.days; ++day) {
+            if (shared.intraday) intraday.runDay(nullptr);
+            else market.simulateFluctuation();
+
+            shared.screenedCount = market.getStockTable().selectFallers(FALL_THRESHOLD, VOLUME_RATIO_THRESHOLD, SCREEN_SIZE,
+                                                                        shared.screened.data());
+            if (shared.screenedCount > 0) crash.notify();
+
+            exec.run();
         }
+
+        Result result;
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.transactions = market.getTransactionHistory().size();
+        result.executor = exec.getStats();
+        result.frames = StrategyFramePool::local().getStats();
+
+        if (cfg.strategies == 0) return result;
+
+        vector<double> multiples(cfg.strategies);
+
+        for (size_t i = 0; i < cfg.strategies; ++i) {
+            multiples[i] = traders[i]->getTotalAssetValue(market) / INITIAL_CASH;
+            result.mean += multiples[i] / cfg.strategies;
+            result.holding += traders[i]->getGapPositionCount() > 0;
+        }
+
+        sort(multiples.begin(), multiples.end());
+        result.worst = multiples.front();
+        result.median = multiples[multiples.size() / 2];
+        result.best = multiples.back();
+
+        return result;
     }
 };
+#endif
 
 // ============================================================
-// 팀원 C: DisruptedState 클래스
+// 공통: BenchmarkSuite (시뮬레이션/전략 핫패스 마이크로벤치마크)
 // ============================================================
-class DisruptedState : public MarketState {
+// 각 항목을 최소 측정 시간 이상이 될 때까지 반복 횟수를 늘려가며 측정하고
+// ns/op, 처리량(items/s), op당 힙 할당 횟수를 표와 JSON으로 출력한다.
+class BenchmarkSuite {
+public:
+    struct Result {
+        string name;
+        string paramName;
+        uint64_t param;
+        uint64_t iterations;
+        double nsPerOp;
+        double itemsPerSec;
+        double allocsPerOp;
+    };
+
 private:
-    static constexpr double INVESTMENT_RATIO = 0.50;
-    static constexpr int MAX_POSITIONS = 3;
+    vector<Result> results;
+    double minSeconds;
 
 public:
-    void handle(Trader& t, Market& m) override {
-        // 특수 전략 실행
-        executeContrarianBuy(t, m);
-        executeGapTrading(t, m);
+    explicit BenchmarkSuite(double minSeconds = 0.2)
+        : minSeconds(minSeconds) {
     }
 
-    string getStateName() const override { return "Disrupted"; }
+    // op 1회가 itemsPerOp개의 항목(종목/포지션 등)을 처리한다고 보고 처리량을 계산
+    template <typename Fn>
+    void run(const string& name, const string& paramName, uint64_t param, double itemsPerOp, Fn op) {
+        op();   // 워밍업 (지연 할당/캐시 적재)
 
-    void executeGapTrading(Trader& t, Market& m) {
-        // 급락 주식 매수
-        if (t.getGapPositionCount() >= MAX_POSITIONS) return;
+        uint64_t iterations = 1;
 
-        Stock* target = selectBestTarget(m);
-        if (!target) return;
+        while (true) {
+            uint64_t allocBefore = AllocationCounter::count();
+            auto start = chrono::steady_clock::now();
 
-        // 이미 보유 중인지 확인
-        const auto& gapPositions = t.getGapPositions();
-        if (gapPositions.find(target->getName()) != gapPositions.end()) return;
+            for (uint64_t i = 0; i < iterations; ++i) op();
 
-        int targetCount = 1;
-        double investAmount = calculateInvestAmount(t, targetCount);
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            uint64_t allocs = AllocationCounter::count() - allocBefore;
 
-        if (investAmount < 1.0) return;
+            if (elapsed >= minSeconds || iterations >= (1ull << 32)) {
+                Result r;
+                r.name = name;
+                r.paramName = paramName;
+                r.param = param;
+                r.iterations = iterations;
+                r.nsPerOp = elapsed * 1e9 / iterations;
+                r.itemsPerSec = elapsed > 0.0 ? itemsPerOp * iterations / elapsed : 0.0;
+                r.allocsPerOp = static_cast<double>(allocs) / iterations;
+                results.push_back(r);
 
-        double price = target->getCurrentPrice();
-        int qty = static_cast<int>(floor(investAmount / price));
+                cout << left << setw(40) << name << right
+                     << setw(8) << paramName << "=" << setw(8) << param
+                     << " | " << setw(14) << fixed << setprecision(1) << r.nsPerOp << " ns/op"
+                     << " | " << setw(14) << setprecision(0) << r.itemsPerSec << " items/s"
+                     << " | " << setw(8) << setprecision(2);
 
-        if (qty <= 0) return;
+                if (AllocationCounter::ENABLED) cout << r.allocsPerOp;
+                else cout << "-";
 
-        bool ok = t.buyGapPosition(target->getName(), qty, m);
+                cout << " allocs/op" << endl;
 
-        if (ok) {
-            double fall = target->getFluctuationRate();
-            cout << "[DisruptedState] 갭 트레이딩 매수: " << target->getName()
-                << " | 수량: " << qty << " | 가격: " << fixed << setprecision(2) << price
-                << " | 하락률: " << fixed << setprecision(2) << (fall * 100) << "%" << endl;
+                return;
+            }
+
+            // 최소 측정 시간에 맞게 반복 횟수 추정 (최대 100배씩)
+            double scale = elapsed > 0.0 ? minSeconds / elapsed * 1.2 : 100.0;
+            iterations = static_cast<uint64_t>(iterations * min(100.0, max(2.0, scale)));
         }
     }
 
-    void executeContrarianBuy(Trader& t, Market& m) {
-        // 역발상 매수
-        if (t.getGapPositionCount() >= MAX_POSITIONS) return;
+    bool writeJson(const string& path) const {
+        ofstream out(path);
+        if (!out) return false;
 
-        Stock* target = selectBestTarget(m);
-        if (!target) return;
+        out << "[\n";
 
-        // 이미 보유 중인지 확인
-        const auto& gapPositions = t.getGapPositions();
-        if (gapPositions.find(target->getName()) != gapPositions.end()) return;
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
 
-        int targetCount = 1;
-        double investAmount = calculateInvestAmount(t, targetCount);
+            out << "  {\"name\": \"" << r.name << "\", \"param\": \"" << r.paramName
+                << "\", \"value\": " << r.param
+                << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << fixed << setprecision(3) << r.nsPerOp
+                << ", \"items_per_sec\": " << setprecision(1) << r.itemsPerSec
+                << ", \"allocs_per_op\": ";
 
-        if (investAmount < 1.0) return;
+            if (AllocationCounter::ENABLED) out << setprecision(4) << r.allocsPerOp;
+            else out << "null";
 
-        double price = target->getCurrentPrice();
-        int qty = static_cast<int>(floor(investAmount / price));
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
 
-        if (qty <= 0) return;
+        out << "]\n";
+
+        return static_cast<bool>(out);
+    }
+};
+
+// 벤치마크용 n종목 시장 구성
+void populateBenchMarket(Market& market, size_t n) {
+    char name[32];
 
-        bool ok = t.buyGapPosition(target->getName(), qty, m);
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(name, sizeof(name), "S%07zu", i);
+        market.addStock(name, 10000.0 + (i % 1000) * 100.0, 100000.0 + (i % 100) * 1000.0);
+    }
+}
+
+// 결과가 최적화로 제거되지 않도록 값을 흘려보낼 곳
+static volatile double benchSink;
+
+#ifdef STOCKSIM_COROUTINES
+static uint64_t benchResumes;
 
-        if (ok) {
-            double fall = target->getFluctuationRate();
-            cout << "[DisruptedState] 역발상 매수: " << target->getName()
-                << " | 수량: " << qty << " | 가격: " << fixed << setprecision(2) << price
-                << " | 하락률: " << fixed << setprecision(2) << (fall * 100) << "%" << endl;
+// 장 마감마다 깨어나는 코루틴 (실행기 재개 비용 측정용)
+StrategyTask benchDailyStrategy(StrategyExecutor& exec) {
+    while (true) {
+        co_await exec.nextDay();
+        ++benchResumes;
+    }
+}
+
+// 바로 끝나는 코루틴 (프레임 풀 할당/해제 비용 측정용)
+StrategyTask benchOneShot() {
+    ++benchResumes;
+    co_return;
+}
+#endif
+
+void runBenchmarks(ThreadPool& pool, size_t maxStocks, const string& jsonPath) {
+    Logger::setLevel(LogLevel::Error);
+
+    BenchmarkSuite suite;
+    const size_t universes[] = { 5, 1000, 100000, 1000000 };
+    const size_t positionCounts[] = { 0, 100, 10000 };
+
+    cout << "[벤치마크] 스레드: " << pool.size() << endl;
+
+    if (!AllocationCounter::ENABLED) cout << "[참고] op당 할당 횟수는 -DSTOCKSIM_BENCH=1 빌드에서만 측정" << endl;
+
+    for (size_t n : universes) {
+        if (n > maxStocks) continue;
+
+        Market market(1);
+        market.setThreadPool(&pool);
+        populateBenchMarket(market, n);
+
+        suite.run("Market::simulateFluctuation", "stocks", n, static_cast<double>(n), [&] {
+            market.simulateFluctuation();
+        });
+
+        Market factorMarket(1);
+        factorMarket.setThreadPool(&pool);
+        factorMarket.enableFactorModel(FactorModel::Config());
+        populateBenchMarket(factorMarket, n);
+        suite.run("Market::simulateFluctuation (factor)", "stocks", n, static_cast<double>(n), [&] {
+            factorMarket.simulateFluctuation();
+        });
+
+        // 이동 구간 지표 (종목당 링 메모리가 크므로 10만 종목까지)
+        if (n <= 100000) {
+            Market indicatorMarket(1);
+            indicatorMarket.setThreadPool(&pool);
+            populateBenchMarket(indicatorMarket, n);
+            indicatorMarket.enableIndicators(RollingIndicators::DEFAULT_WINDOW);
+
+            suite.run("Market::simulateFluctuation (indicators)", "stocks", n, static_cast<double>(n), [&] {
+                indicatorMarket.simulateFluctuation();
+            });
+
+            const RollingIndicators& indicators = *indicatorMarket.getIndicators();
+            StockTable::Candidate screened[10];
+            suite.run("RollingIndicators::selectDrawdowns", "stocks", n, static_cast<double>(n), [&] {
+                benchSink = static_cast<double>(indicators.selectDrawdowns(-0.1, 1.0, 10, screened));
+            });
         }
+
+        suite.run("Market::getMarketVolatility", "stocks", n, static_cast<double>(n), [&] {
+            benchSink = market.getMarketVolatility();
+        });
+
+        DisruptionDetector detector;
+        suite.run("DisruptionDetector::calculateScore", "stocks", n, static_cast<double>(n), [&] {
+            benchSink = detector.calculateScore(market);
+        });
+
+        DisruptedState disrupted;
+        suite.run("DisruptedState::selectBestTarget", "stocks", n, static_cast<double>(n), [&] {
+            Stock* target = disrupted.selectBestTarget(market);
+            benchSink = target ? target->getCurrentPrice() : 0.0;
+        });
+
+        PriceHistory history(PriceHistory::BLOCK_DAYS * 4);
+        uint64_t historyDay = 0;
+        suite.run("PriceHistory::record", "stocks", n, static_cast<double>(n), [&] {
+            history.record(historyDay++, market.getStockTable());
+        });
+
+        vector<MarketBar> bars;
+        suite.run("PriceHistory::lastDays (30)", "stocks", n, 30.0, [&] {
+            history.lastDays(static_cast<SymbolId>(historyDay % n), 30, bars);
+            benchSink = bars.back().price;
+        });
+
+        Trader trader("bench", 10000000.0);
+        suite.run("Trader::autoTrade (day)", "stocks", n, static_cast<double>(n), [&] {
+            market.simulateFluctuation();
+            trader.autoTrade(market);
+        });
+
+        // 장중 하루: 종목당 평균 64틱, 단위는 처리한 틱 수
+        IntradaySimulator intraday(market, 64);
+        Trader intradayTrader("bench", 10000000.0);
+        uint64_t eventsBefore = 0;
+        suite.run("IntradaySimulator::runDay (64 ticks)", "stocks", n, static_cast<double>(n) * 64.0, [&] {
+            intraday.runDay(&intradayTrader);
+            benchSink = static_cast<double>(intraday.getStats().events - eventsBefore);
+            eventsBefore = intraday.getStats().events;
+        });
     }
 
-    Stock* selectBestTarget(Market& m) {
-        // 역발상 매수 대상 선정 조건: 가격 하락률 < -15% & 거래량 비율 > 2.0 (200%)
-        // 우선 순위: 하락률 (최대) -> 거래량 비율 (최대)
-        Stock* best = nullptr;
-        double bestFall = 0.0;
-        double bestVolRatio = 0.0;
+    // 주문장: 호가 200개에 주문 1만 건이 쌓인 상태에서 측정
+    {
+        OrderBook book;
+        book.reset(10000.0, 10.0);
+        vector<OrderBook::Fill> fills;
+        fills.reserve(64);
+
+        for (int i = 0; i < 10000; ++i) {
+            int32_t k = 1 + i % 100;
+            book.addLimit(OrderSide::Sell, 10000.0 + k * 10.0, 10, 1, fills);
+            book.addLimit(OrderSide::Buy, 10000.0 - k * 10.0, 10, 1, fills);
+        }
 
-        for (Stock* s : m.getAllStocks()) {
-            if (!s) continue;
+        uint32_t step = 0;
+        suite.run("OrderBook::addLimit + cancel", "orders", 20000, 2.0, [&] {
+            int32_t k = 1 + static_cast<int32_t>(step++ % 100);
+            OrderId id = book.addLimit(step % 2 ? OrderSide::Buy : OrderSide::Sell,
+                                       step % 2 ? 10000.0 - k * 10.0 : 10000.0 + k * 10.0, 5, 2, fills);
+            book.cancel(id);
+        });
+
+        // 최우선 호가 잔량(10주 x 100건)을 넘지 않는 시장가 주문 + 같은 수량 재보충
+        suite.run("OrderBook::marketOrder + refill", "orders", 20000, 2.0, [&] {
+            fills.clear();
+            book.marketOrder(OrderSide::Buy, 25, numeric_limits<double>::infinity(), fills);
+            book.addLimit(OrderSide::Sell, book.bestAskPrice(), 25, 1, fills);
+        });
+    }
 
-            double fall = s->getFluctuationRate();
-            double volRatio = s->getVolumeRatio();
+    // 몬테카를로 경로 하나 (기본 시장 구성 + 10일 자동매매): 힙 vs 경로마다 reset하는 Arena
+    {
+        uint64_t pathSeed = 0;
 
-            if (fall < -0.15 && volRatio > 2.0) {
-                if (best == nullptr || fall < bestFall || (fabs(fall - bestFall) < 1e-9 && volRatio > bestVolRatio)) {
-                    best = s;
-                    bestFall = fall;
-                    bestVolRatio = volRatio;
-                }
+        auto runPath = [&](Arena* arena) {
+            Market market(pathSeed++, arena);
+            populateDefaultMarket(market);
+            Trader trader("bench", 10000000.0, StrategyParams(), arena);
+
+            for (int day = 0; day < 10; ++day) {
+                market.simulateFluctuation();
+                trader.autoTrade(market);
             }
-        }
 
-        return best;
+            benchSink = trader.getTotalAssetValue(market);
+        };
+
+        suite.run("Monte Carlo path (heap)", "days", 10, 10.0, [&] { runPath(nullptr); });
+
+        Arena arena;
+        suite.run("Monte Carlo path (arena)", "days", 10, 10.0, [&] {
+            runPath(&arena);
+            arena.reset();
+        });
     }
 
-    double calculateInvestAmount(const Trader& t, int targets) {
-        if (targets <= 0) return 0.0;
+    // 스냅샷: 저장, 열기(매핑 + 종목명 표), 분기 하나 복원 (Arena, 종목명 표 공유)
+    {
+        size_t n = min<size_t>(maxStocks, 100000);
+        string path = string(P_tmpdir) + "/stocksim_bench.snap";
+        Market market(1);
+        populateBenchMarket(market, n);
+        market.simulateFluctuation();
 
-        double cash = t.getCash();
+        Trader trader("bench", 1e12);
+        for (size_t i = 0; i < min<size_t>(n, 100); ++i) trader.buyGapPosition(static_cast<SymbolId>(i), 1, market);
+
+        suite.run("SimulationSnapshot::write", "stocks", n, static_cast<double>(n), [&] {
+            benchSink = SimulationSnapshot::write(path, market, { &trader });
+        });
+
+        SimulationSnapshot snapshot;
+        suite.run("SimulationSnapshot::open", "stocks", n, static_cast<double>(n), [&] {
+            benchSink = snapshot.open(path);
+        });
 
-        return (cash * INVESTMENT_RATIO) / static_cast<double>(targets);
+        Arena arena;
+        suite.run("SimulationSnapshot fork (restore)", "stocks", n, static_cast<double>(n), [&] {
+            {
+                Market fork(0, &arena);
+                snapshot.restoreMarket(fork);
+                benchSink = snapshot.restoreTrader(0, fork, &arena)->getTotalAssetValue(fork);
+            }
+
+            arena.reset();
+        });
+
+        snapshot.close();
+        remove(path.c_str());
     }
-};
+
+    // 보유 포지션 수별 평가 (일반/갭 포지션 절반씩)
+    size_t positionUniverse = min<size_t>(maxStocks, 10000);
+    Market market(1);
+    populateBenchMarket(market, max<size_t>(positionUniverse, 5));
+
+    for (size_t count : positionCounts) {
+        if (count > positionUniverse) continue;
+
+        Trader trader("bench", 1e15);
+
+        for (size_t i = 0; i < count; ++i) {
+            SymbolId id = static_cast<SymbolId>(i);
+
+            if (i % 2 == 0) trader.buy(id, 1, market);
+            else trader.buyGapPosition(id, 1, market);
+        }
+
+        // 평가 누계가 최신이면 O(1)
+        suite.run("Trader::getTotalAssetValue", "positions", count, static_cast<double>(max<size_t>(count, 1)), [&] {
+            benchSink = trader.getTotalAssetValue(market);
+        });
+
+        // 시세가 바뀐 직후: 보유 포지션 전체를 차이만큼 다시 평가
+        Stock* first = market.getStockById(0);
+        suite.run("Trader::getTotalAssetValue (repriced)", "positions", count, static_cast<double>(max<size_t>(count, 1)), [&] {
+            first->updatePrice(first->getCurrentPrice());
+            benchSink = trader.getTotalAssetValue(market);
+        });
+
+        // 가격 변동 없음 -> 청산 대상 없이 전체 스캔만 측정
+        NormalState normal;
+        suite.run("NormalState::checkGapPositionRecovery", "positions", count, static_cast<double>(max<size_t>(count / 2, 1)), [&] {
+            normal.checkGapPositionRecovery(trader, market);
+        });
+    }
+
+#ifdef STOCKSIM_COROUTINES
+    // 코루틴 전략 실행기: 장 마감 한 번에 대기 중인 코루틴 n개 재개 / 코루틴 n개 생성 후 완료
+    for (size_t count : { size_t(1000), size_t(100000) }) {
+        Market market(1);
+        populateBenchMarket(market, 5);
+        StrategyExecutor exec(market);
+
+        for (size_t k = 0; k < count; ++k) exec.spawn(benchDailyStrategy(exec));
+        exec.run();
+
+        suite.run("StrategyExecutor::run (nextDay)", "tasks", count, static_cast<double>(count), [&] {
+            market.simulateFluctuation();
+            exec.run();
+        });
+
+        suite.run("StrategyExecutor::spawn + complete", "tasks", count, static_cast<double>(count), [&] {
+            for (size_t k = 0; k < count; ++k) exec.spawn(benchOneShot());
+            exec.run();
+        });
+    }
+#endif
+
+    if (!jsonPath.empty()) {
+        if (suite.writeJson(jsonPath)) cout << "[벤치마크] JSON 결과: " << jsonPath << endl;
+        else Logger::error("[오류] 벤치마크 결과를 쓸 수 없음: ", jsonPath);
+    }
+}
 
 // ============================================================
-// 팀원 C: DisruptionDetector 클래스
+// Main (테스트용)
 // ============================================================
-class DisruptionDetector {
-private:
-    unique_ptr<MarketState> currentState;
-    double disruptionScore;
-    static constexpr double THRESHOLD = 70.0;
-    static constexpr double RECOVERY_THRESHOLD = 50.0;
-    double previousScore;
+int main(int argc, char* argv[]) {
+    // 실행 옵션: --seed N (재현용 난수 시드), --threads N (시뮬레이션 스레드 수),
+    //           --days N (시뮬레이션 일수), --batch N (N개 경로 몬테카를로 배치 실행),
+    //           --journal PATH (거래 내역을 바이너리 저널 파일로 기록),
+    //           --log-level silent|error|info|verbose (출력 상세도, 기본 verbose),
+    //           --bench (마이크로벤치마크), --bench-json PATH, --bench-max-stocks N,
+    //           --replay PATH (과거 시세 파일 재생), --convert-csv CSV OUT (CSV -> 시세 파일 변환),
+    //           --history N (일별 시세 이력 기록, 최근 N일 보존, 0이면 전체),
+    //           --sweep grid|N (전략 매개변수 격자/무작위 N개 탐색), --sweep-top K,
+    //           --order-book (매매를 종목별 주문장 체결로 실행),
+    //           --intraday N (장중 틱 시뮬레이션, 종목당 하루 평균 N틱),
+    //           --agents N (하나의 시장에서 Trader N명 동시 매매),
+    //           --profile-json PATH, --profile-prom PATH (-DSTOCKSIM_PROFILE 빌드의 프로브 측정 결과 내보내기),
+    //           --save-snapshot PATH (마지막 날 상태 저장), --load-snapshot PATH (저장된 상태에서 이어서 실행),
+    //           --fork N (--load-snapshot 상태에서 시드만 다른 what-if 분기 N개 실행),
+    //           --factor-model (시장/섹터 상관 요인 모형 + 시장 전체 급락), --sectors N, --jump-prob P,
+    //           --indicators N (종목별 N일 이동 구간 지표),
+    //           --coroutines N (C++20 코루틴 전략 N개를 단일 스레드 실행기로 실행, -std=c++20 빌드)
+    uint64_t seed = static_cast<uint64_t>(time(nullptr));
+    size_t threads = 1;
+    int days = 10;
+    uint64_t batchPaths = 0;
+    string journalPath;
+    LogLevel logLevel = LogLevel::Verbose;
+    bool bench = false;
+    string benchJsonPath;
+    size_t benchMaxStocks = 1000000;
+    string replayPath;
+    bool daysGiven = false;
+    bool history = false;
+    size_t historyDays = 0;
+    size_t indicatorWindow = 0;
+    string sweepMode;
+    size_t sweepTop = 10;
+    bool orderBook = false;
+    uint32_t intradayTicks = 0;
+    size_t agentCount = 0;
+    size_t coroutineCount = 0;
+    string profileJsonPath;
+    string profilePromPath;
+    bool seedGiven = false;
+    string snapshotSavePath;
+    string snapshotLoadPath;
+    size_t forkBranches = 0;
+    bool useFactorModel = false;
+    FactorModel::Config factorConfig;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+            seedGiven = true;
+        }
 
-public:
-    DisruptionDetector()
-        : currentState(nullptr), disruptionScore(0.0), previousScore(0.0) {
-        // 초기 상태는 NormalState
-        currentState = make_unique<NormalState>();
-    }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = max<size_t>(1, strtoull(argv[++i], nullptr, 10));
+        }
 
-    void analyzeMarket(Market& m) {
-        previousScore = disruptionScore;
-        disruptionScore = calculateScore(m);
+        else if (arg == "--days" && i + 1 < argc) {
+            days = max(1, atoi(argv[++i]));
+            daysGiven = true;
+        }
 
-        // 상태 전환 로직
-        if (disruptionScore > THRESHOLD) {
-            // disruptionScore > 70 -> DisruptedState로 전환
-            if (getCurrentStateName() != "Disrupted") {
-                changeState(new DisruptedState());
-                cout << "[DisruptionDetector] 상태 전환 -> Disrupted" << endl;
-            }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
         }
 
-        else if (disruptionScore < RECOVERY_THRESHOLD) {
-            // disruptionScore < 50 -> NormalState로 복귀
-            if (getCurrentStateName() != "Normal") {
-                changeState(new NormalState());
-                cout << "[DisruptionDetector] 상태 전환 -> Normal" << endl;
+        else if (arg == "--convert-csv" && i + 2 < argc) {
+            string csvPath = argv[++i];
+            string outPath = argv[++i];
+            string error;
+
+            if (!MarketReplay::convertCsv(csvPath, outPath, error)) {
+                Logger::error("[오류] CSV 변환 실패: ", error);
+                return 1;
             }
+
+            cout << "[CSV 변환 완료]: " << outPath << endl;
+            return 0;
         }
 
-        else {
-            // 50 <= disruptionScore <= 70: 현재 상태 유지
+        else if (arg == "--history" && i + 1 < argc) {
+            history = true;
+            historyDays = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--indicators" && i + 1 < argc) {
+            indicatorWindow = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--order-book") {
+            orderBook = true;
+        }
+
+        else if (arg == "--sweep" && i + 1 < argc) {
+            sweepMode = argv[++i];
+        }
+
+        else if (arg == "--sweep-top" && i + 1 < argc) {
+            sweepTop = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--intraday" && i + 1 < argc) {
+            intradayTicks = static_cast<uint32_t>(max(1, atoi(argv[++i])));
+        }
+
+        else if (arg == "--agents" && i + 1 < argc) {
+            agentCount = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--coroutines" && i + 1 < argc) {
+            coroutineCount = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--profile-json" && i + 1 < argc) {
+            profileJsonPath = argv[++i];
+        }
+
+        else if (arg == "--profile-prom" && i + 1 < argc) {
+            profilePromPath = argv[++i];
+        }
+
+        else if (arg == "--save-snapshot" && i + 1 < argc) {
+            snapshotSavePath = argv[++i];
+        }
+
+        else if (arg == "--load-snapshot" && i + 1 < argc) {
+            snapshotLoadPath = argv[++i];
+        }
+
+        else if (arg == "--fork" && i + 1 < argc) {
+            forkBranches = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--factor-model") {
+            useFactorModel = true;
+        }
+
+        else if (arg == "--sectors" && i + 1 < argc) {
+            useFactorModel = true;
+            factorConfig.sectors = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--jump-prob" && i + 1 < argc) {
+            useFactorModel = true;
+            factorConfig.jumpProbability = strtod(argv[++i], nullptr);
+        }
+
+        else if (arg == "--batch" && i + 1 < argc) {
+            batchPaths = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--journal" && i + 1 < argc) {
+            journalPath = argv[++i];
+        }
+
+        else if (arg == "--bench") {
+            bench = true;
+        }
+
+        else if (arg == "--bench-json" && i + 1 < argc) {
+            benchJsonPath = argv[++i];
+        }
+
+        else if (arg == "--bench-max-stocks" && i + 1 < argc) {
+            benchMaxStocks = strtoull(argv[++i], nullptr, 10);
+        }
+
+        else if (arg == "--log-level" && i + 1 < argc) {
+            if (!Logger::parseLevel(argv[++i], logLevel)) {
+                Logger::error("[오류] 알 수 없는 로그 레벨: ", argv[i]);
+                return 1;
+            }
         }
     }
 
-    void changeState(MarketState* newState) {
-        if (!newState) return;
+    // 스레드 풀보다 먼저 만들어 풀의 작업 스레드가 모두 끝난 뒤에 기록되도록 함
+    ProfileExporter profileExporter(profileJsonPath, profilePromPath);
 
-        currentState.reset(newState);
+    ThreadPool pool(threads);
+    const FactorModel::Config* factors = useFactorModel ? &factorConfig : nullptr;
+
+    if (bench) {
+        runBenchmarks(pool, benchMaxStocks, benchJsonPath);
+        return 0;
     }
 
-    void executeStrategy(Trader& t, Market& m) {
-        if (currentState) {
-            currentState->handle(t, m);
-        }
+    if (!sweepMode.empty()) {
+        return runSweep(pool, sweepMode, sweepTop, seed, daysGiven || replayPath.empty() ? days : INT32_MAX, replayPath, factors);
     }
 
-    double calculateScore(Market& m) const {
-        // 위험도 계산: disruptionScore = (현재 거래량 / 평균 거래량) x 변동성 x 1000
-        // 현재 거래량 / 평균 거래량은 최대 거래량 비율을 사용하여 가장 과도한 종목을 잡음
-        const vector<Stock*>& stocks = m.getAllStocks();
-        if (stocks.empty()) return 0.0;
+    if (batchPaths > 0) {
+        // 배치 경로는 오류 외 출력 없이 실행하고 결과 요약만 표준 출력에 기록
+        Logger::setLevel(LogLevel::Error);
 
+        MonteCarloRunner::Config cfg;
+        cfg.paths = batchPaths;
+        cfg.days = days;
+        cfg.seed = seed;
+        cfg.factorModel = factors;
 
-        double maxVolRatio = 0.0;
+        cout << "[몬테카를로 배치] 경로: " << cfg.paths << " | 일수: " << cfg.days
+             << " | 스레드: " << pool.size() << " | 시드: " << seed << endl;
 
-        for (Stock* s : stocks) {
-            double vr = s->getVolumeRatio();
+        auto start = chrono::steady_clock::now();
+        MonteCarloRunner::Result result = MonteCarloRunner(cfg).run(pool);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-            if (vr > maxVolRatio) maxVolRatio = vr;
+        result.finalAsset.print();
+        result.drawdown.print();
+        result.transitions.print();
+        result.gapProfit.print();
+        result.disruptedDwell.print();
+
+        cout << "\n[처리 시간]: " << fixed << setprecision(3) << seconds << "s"
+             << " | 처리량: " << fixed << setprecision(0) << (cfg.paths / seconds) << " 경로/s" << endl;
+
+        return 0;
+    }
+
+    // 스냅샷: 시드를 따로 주지 않으면 저장된 시드로 이어서 실행 (같은 시드면 중단 없이 실행한 것과 같은 결과)
+    SimulationSnapshot snapshot;
+
+    if (!snapshotLoadPath.empty()) {
+        if (!snapshot.open(snapshotLoadPath) || snapshot.getTraderCount() == 0) {
+            Logger::error("[오류] 스냅샷을 열 수 없음: ", snapshotLoadPath);
+            return 1;
         }
 
-        double volatility = m.getMarketVolatility();
-        double score = maxVolRatio * volatility * 1000.0;
+        if (!replayPath.empty()) {
+            Logger::error("[오류] --load-snapshot은 --replay와 함께 사용할 수 없음");
+            return 1;
+        }
 
-        return score;
+        if (!seedGiven) seed = snapshot.getSeed();
     }
 
-    bool checkRecovery() const {
-        return disruptionScore < RECOVERY_THRESHOLD;
+    if (forkBranches > 0) {
+        if (!snapshot.isOpen()) {
+            Logger::error("[오류] --fork는 --load-snapshot이 필요함");
+            return 1;
+        }
+
+        Logger::setLevel(LogLevel::Error);
+
+        SnapshotForks::Config cfg;
+        cfg.branches = forkBranches;
+        cfg.days = days;
+        cfg.seed = seed;
+        cfg.factorModel = factors;
+
+        cout << "[스냅샷 분기] 분기: " << cfg.branches << " | 시작 일차: " << snapshot.getDay()
+             << " | 종목: " << snapshot.getStockCount() << " | 트레이더: " << snapshot.getTraderCount()
+             << " | 일수: " << cfg.days << " | 스레드: " << pool.size() << " | 시드: " << seed << endl;
+
+        SnapshotForks::Result result = SnapshotForks(cfg).run(snapshot, pool);
+
+        cout << fixed << setprecision(4)
+             << "[최종 자산 배수] 최저: " << result.worst << " | 중앙값: " << result.median
+             << " | 평균: " << result.mean << " | 최고: " << result.best << endl;
+        cout << "[처리 시간]: " << setprecision(3) << result.seconds << "s"
+             << " | 처리량: " << setprecision(0) << (cfg.branches / result.seconds) << " 분기/s" << endl;
+
+        return 0;
     }
 
-    double getDisruptionScore() const {
-        return disruptionScore;
+    if (coroutineCount > 0) {
+#ifdef STOCKSIM_COROUTINES
+        // 전략별 로그는 생략하고 분포 요약만 표준 출력에 기록
+        Logger::setLevel(LogLevel::Error);
+
+        CoroutineStrategies::Config cfg;
+        cfg.strategies = coroutineCount;
+        cfg.days = days;
+        cfg.seed = seed;
+        cfg.intradayTicks = intradayTicks;
+        cfg.factorModel = factors;
+
+        cout << "[코루틴 전략] 전략: " << cfg.strategies << " | 일수: " << cfg.days
+             << " | 장중 틱: " << cfg.intradayTicks << " | 시드: " << seed << endl;
+
+        CoroutineStrategies::Result result = CoroutineStrategies(cfg).run(pool);
+
+        cout << fixed << setprecision(4)
+             << "[최종 자산 배수] 최저: " << result.worst << " | 중앙값: " << result.median
+             << " | 평균: " << result.mean << " | 최고: " << result.best << endl;
+        cout << "[거래 내역]: " << result.transactions << "건 | 주문: " << result.executor.orders
+             << " | 체결: " << result.executor.fills << " | 종료 시 보유 전략: " << result.holding << endl;
+        cout << "[코루틴] 재개: " << result.executor.resumes << "회 | 최대 동시: " << result.executor.peakTasks
+             << " | 프레임: " << result.frames.largestFrame << "바이트 | 프레임 풀: "
+             << result.frames.blockBytes / 1024 << "KB" << endl;
+        cout << "[처리 시간]: " << setprecision(3) << result.seconds << "s"
+             << " | 처리량: " << setprecision(0) << (cfg.strategies * static_cast<double>(cfg.days) / result.seconds)
+             << " 전략-일/s" << endl;
+
+        return 0;
+#else
+        Logger::error("[오류] --coroutines는 C++20 빌드가 필요함 (-std=c++20)");
+        return 1;
+#endif
     }
 
-    bool isDisrupted() const {
-        return disruptionScore > THRESHOLD;
+    if (agentCount > 0) {
+        // 에이전트별 로그는 생략하고 분포 요약만 표준 출력에 기록
+        Logger::setLevel(LogLevel::Error);
+
+        AgentSimulation::Config cfg;
+        cfg.agents = agentCount;
+        cfg.days = days;
+        cfg.seed = seed;
+        cfg.orderBook = orderBook;
+        cfg.factorModel = factors;
+
+        cout << "[다중 에이전트] 에이전트: " << cfg.agents << " | 일수: " << cfg.days
+             << " | 스레드: " << pool.size() << " | 주문장: " << (cfg.orderBook ? "사용" : "미사용")
+             << " | 시드: " << seed << endl;
+
+        AgentSimulation::Result result = AgentSimulation(cfg).run(pool);
+
+        cout << fixed << setprecision(4)
+             << "[최종 자산 배수] 최저: " << result.worst << " | 중앙값: " << result.median
+             << " | 평균: " << result.mean << " | 최고: " << result.best << endl;
+        cout << "[거래 내역]: " << result.transactions << "건" << endl;
+        cout << "[처리 시간]: " << setprecision(3) << result.seconds << "s"
+             << " | 처리량: " << setprecision(0) << (cfg.agents * static_cast<double>(cfg.days) / result.seconds)
+             << " 에이전트-일/s" << endl;
+
+        return 0;
     }
 
-    string getCurrentStateName() const {
-        if (currentState) return currentState->getStateName();
+    Logger::setLevel(logLevel);
+    Logger::write(LogLevel::Info, LogCode::Banner);
+
+    // 팀원 A: Market, Stock 테스트
+    Market market(seed);
+    market.setThreadPool(&pool);
 
-        return "Unknown";
+    // 과거 시세 재생 모드: 파일의 종목으로 시장 구성, 0일차가 초기 상태
+    MarketReplay replay;
+
+    if (snapshot.isOpen()) {
+        snapshot.restoreMarket(market);
+        market.setSeed(seed);
     }
-};
 
-// ============================================================
-// Trader::autoTrade() 구현 (DisruptionDetector 정의 후)
-// ============================================================
-void Trader::autoTrade(Market& m) {
-    if (!detector) return;
+    else if (!replayPath.empty()) {
+        if (!replay.open(replayPath) || !replay.populate(market)) {
+            Logger::error("[오류] 시세 파일을 열 수 없음: ", replayPath);
+            return 1;
+        }
 
-    // 1) 시장 분석
-    detector->analyzeMarket(m);
+        int available = static_cast<int>(min<size_t>(replay.getDayCount() - 1, INT32_MAX));
+        days = daysGiven ? min(days, available) : available;
+    }
 
-    // 로그
-    cout << "[자동매매] 현재 상태: " << detector->getCurrentStateName()
-        << " | DisruptionScore: " << fixed << setprecision(2) << detector->getDisruptionScore() << endl;
+    else {
+        populateDefaultMarket(market);
+    }
 
-    // 2) 현재 상태에 따른 전략 실행
-    detector->executeStrategy(*this, m);
-}
+    if (!journalPath.empty() && !market.openJournal(journalPath)) {
+        Logger::error("[오류] 거래 저널을 열 수 없음 (형식 또는 종목 구성 불일치): ", journalPath);
+        return 1;
+    }
 
-// ============================================================
-// Main (테스트용)
-// ============================================================
-int main() {
-    srand(static_cast<unsigned>(time(nullptr)));
+    if (history) market.enableHistory(historyDays);
+    // 스냅샷에서 이어서 실행하면 저장된 지표 상태를 그대로 이어받음 (새로 켜면 끊지 않은 실행과 값이 달라짐)
+    if (indicatorWindow > 0 && snapshot.isOpen()) {
+        if (!snapshot.restoreIndicators(market, indicatorWindow)) {
+            Logger::error("[오류] 스냅샷에 같은 구간 일수의 지표 상태가 없음 (--indicators): ", snapshotLoadPath);
+            return 1;
+        }
+    }
 
-    cout << "==============================" << endl;
-    cout << "     [주식 거래 프로그램]     " << endl;
-    cout << "==============================\n" << endl;
+    else if (indicatorWindow > 0) {
+        market.enableIndicators(indicatorWindow);
+    }
+    if (orderBook) market.enableOrderBooks();
+    if (factors) market.enableFactorModel(*factors);
 
-    // 팀원 A: Market, Stock 테스트
-    Market market;
-    market.addStock(new Stock("삼성전자", 70000.0, 1000000.0));
-    market.addStock(new Stock("SK하이닉스", 130000.0, 500000.0));
-    market.addStock(new Stock("네이버", 200000.0, 300000.0));
-    market.addStock(new Stock("카카오", 50000.0, 800000.0));
-    market.addStock(new Stock("LG에너지솔루션", 400000.0, 200000.0));
-
-    cout << "[초기 상태]" << endl;
+    Logger::write(LogLevel::Info, LogCode::Seed, {}, static_cast<int64_t>(seed));
+
+    Logger::text(LogLevel::Info, "[초기 상태]");
     market.printMarketStatus();
 
-    // Trader 생성 (예시)
-    Trader trader("F team trader", 10000000.0);  // 초기 현금 1천만 원 (단위 가정)
+    // Trader 생성 (예시), 스냅샷이 있으면 저장된 첫 번째 트레이더
+    ArenaPtr<Trader> traderOwner = snapshot.isOpen()
+        ? snapshot.restoreTrader(0, market)
+        : makeArenaPtr<Trader>(nullptr, "F team trader", 10000000.0);  // 초기 현금 1천만 원 (단위 가정)
+    Trader& trader = *traderOwner;
 
-    cout << "[자동매매 10일]" << endl;
+    Logger::write(LogLevel::Info, LogCode::TradingDays, {}, days);
 
-    for (int day = 1; day <= 10; ++day) {
-        cout << "--- [Day " << day << "]---" << endl;
-        market.simulateFluctuation();
+    // 장중 모드: 틱마다 시세가 움직이고 사건이 생길 때 전략 실행 (과거 시세 재생 시에는 사용 안 함)
+    IntradaySimulator intraday(market, intradayTicks);
+
+    for (int day = 1; day <= days; ++day) {
+        Logger::write(LogLevel::Info, LogCode::DayHeader, {}, day);
+
+        if (replay.getDayCount() > 0) market.replayDay(replay.bars(day));
+        else if (intradayTicks > 0) intraday.runDay(&trader);
+        else market.simulateFluctuation();
         market.printMarketStatus();
 
         // 팀원 B, C: Trader 테스트
@@ -906,12 +8069,32 @@ int main() {
         trader.autoTrade(market);
         trader.printPortfolioStatus();
         trader.printGapPositionStatus();
-        cout << "[현금]: " << fixed << setprecision(0) << trader.getCash()
-            << " | [전체 자산 평가]: " << fixed << setprecision(0) << trader.getTotalAssetValue(market) << "\n" << endl;
+        if (Logger::enabled(LogLevel::Info)) {
+            Logger::write(LogLevel::Info, LogCode::AssetLine, { trader.getCash(), trader.getTotalAssetValue(market) });
+        }
+    }
+
+    if (intradayTicks > 0 && replay.getDayCount() == 0) {
+        const IntradaySimulator::Stats& stats = intraday.getStats();
+        Logger::write(LogLevel::Info, LogCode::IntradaySummary, { static_cast<double>(stats.strategyRuns) },
+                      static_cast<int64_t>(stats.events));
     }
 
-    cout << "\n====== [최종 거래 내역] ======" << endl;
+    Logger::text(LogLevel::Info, "\n====== [최종 거래 내역] ======");
     market.printTransactionHistory();
+    market.printPriceHistory();
+
+    // market이 소멸되기 전에 (종목명을 참조하는) 남은 로그를 모두 출력
+    Logger::flush();
+
+    if (!snapshotSavePath.empty()) {
+        if (!SimulationSnapshot::write(snapshotSavePath, market, { &trader })) {
+            Logger::error("[오류] 스냅샷을 저장할 수 없음: ", snapshotSavePath);
+            return 1;
+        }
+
+        cout << "[스냅샷 저장]: " << snapshotSavePath << " (" << market.getDay() << "일차)" << endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file